@@ -0,0 +1,52 @@
+#ifndef BATCHREPORT_H
+#define BATCHREPORT_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Результат обработки одного изображения в пакетном режиме
+struct ImageRecord {
+    std::string path;
+    int width = 0;
+    int height = 0;
+    double decode_ms = 0.0;   // imread
+    double process_ms = 0.0;  // сегментация
+    double encode_ms = 0.0;   // запись debug-изображений
+    bool ok = false;
+    bool tiled = false;       // обработано по тайлам из-за бюджета памяти
+    double shadow_percentage = 0.0;
+
+    double totalMs() const { return decode_ms + process_ms + encode_ms; }
+    double megapixels() const { return width * static_cast<double>(height) / 1e6; }
+};
+
+// Итоговая статистика пакетной обработки: пропускная способность,
+// перцентили задержек по этапам, пиковая память и самые медленные файлы
+class BatchReport {
+public:
+    void addRecord(const ImageRecord& record);
+    // Человекочитаемая сводка
+    void printSummary(std::ostream& out, double wall_ms) const;
+    // Машиночитаемый отчет (JSON)
+    bool writeJson(const std::string& path, double wall_ms) const;
+    // Пиковый RSS процесса в байтах (0, если недоступно)
+    static size_t peakRssBytes();
+private:
+    struct Percentiles {
+        double p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0;
+    };
+    struct Summary {
+        Percentiles decode, process, encode, total;
+        double megapixels = 0.0;
+        int succeeded = 0;
+    };
+    static Percentiles computePercentiles(std::vector<double> values);
+    Summary summarize() const;
+    std::vector<const ImageRecord*> slowest(size_t count) const;
+
+    std::vector<ImageRecord> records;
+    static const size_t slowest_count = 10;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef FRAMESTREAM_H
+#define FRAMESTREAM_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+// Формат кадров на stdin
+enum class StreamInput {
+    Bgr24, // сырые кадры BGR24 заданного размера, подряд
+    Y4m    // YUV4MPEG2 (C420*, Cmono), размер берется из заголовка
+};
+
+// Формат масок на stdout
+enum class StreamOutput {
+    Raw,   // 1 байт на пиксель (0 / 255)
+    Packed // компактная маска: 1 бит на пиксель, строки по ceil(width / 8) байт, старший бит - левый пиксель
+};
+
+struct StreamOptions {
+    int width = 0;
+    int height = 0;
+    StreamInput input = StreamInput::Bgr24;
+    StreamOutput output = StreamOutput::Raw;
+    std::string exclusion_mask; // путь к статической маске исключения (необязательно)
+};
+
+// Потоковый режим: чтение кадров из stdin, сегментация и запись масок в stdout.
+// Чтение, обработка и запись идут в отдельных потоках с двойной буферизацией.
+// Возвращает код завершения процесса
+int runStreaming(const StreamOptions& options);
+
+// Упаковка бинарной маски CV_8UC1 в компактный формат (1 бит на пиксель)
+void packMask(const cv::Mat& mask, std::vector<uchar>& packed);
+
+#endif
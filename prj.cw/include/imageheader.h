@@ -0,0 +1,16 @@
+#ifndef IMAGEHEADER_H
+#define IMAGEHEADER_H
+
+#include <string>
+
+// Размеры изображения, прочитанные из заголовка файла без декодирования
+struct ImageHeader {
+    int width = 0;
+    int height = 0;
+};
+
+// Читает заголовок JPEG, PNG или BMP. Возвращает false для других форматов
+// и поврежденных файлов
+bool readImageHeader(const std::string& path, ImageHeader& header);
+
+#endif
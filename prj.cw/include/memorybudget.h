@@ -0,0 +1,36 @@
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+// Контроль допуска задач по памяти: задача стартует, только пока сумма
+// оценок рабочих наборов запущенных задач не превышает бюджет
+class MemoryBudget {
+public:
+    // limit_bytes == 0 - без ограничения
+    explicit MemoryBudget(size_t limit_bytes = 0);
+    // Блокирует, пока задача не помещается в бюджет. Задача больше бюджета
+    // допускается, только когда других задач нет
+    void acquire(size_t bytes);
+    void release(size_t bytes);
+
+    bool isLimited() const { return limit > 0; }
+    size_t getLimit() const { return limit; }
+    size_t getPeakInUse() const;
+
+    // Разбор размера вида "4096", "512M", "8G" (без суффикса - мегабайты).
+    // Возвращает false при ошибке
+    static bool parseSize(const std::string& text, size_t& bytes);
+private:
+    size_t limit;
+    size_t in_use = 0;
+    size_t peak_in_use = 0;
+    int active = 0;
+    mutable std::mutex mutex;
+    std::condition_variable released;
+};
+
+#endif
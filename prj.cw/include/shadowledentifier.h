@@ -3,19 +3,77 @@
 
 #include <opencv2/opencv.hpp>
 #include <string>
+#include <vector>
+
+// Область обработки кадра: список ROI или статическая маска исключения.
+// Строится один раз на камеру и переиспользуется для всех кадров
+class ProcessingRegion {
+public:
+    ProcessingRegion() = default;
+    // Обрабатываются только пиксели внутри rois
+    ProcessingRegion(cv::Size frame_size, const std::vector<cv::Rect>& rois, int tile_size = default_tile_size);
+    // Ненулевые пиксели exclusion_mask (CV_8UC1) исключаются из обработки
+    explicit ProcessingRegion(const cv::Mat& exclusion_mask, int tile_size = default_tile_size);
+    // Загрузка маски исключения из файла (пустая область при ошибке)
+    static ProcessingRegion fromExclusionMaskFile(const std::string& path, int tile_size = default_tile_size);
+
+    bool empty() const { return include_mask.empty(); }
+    cv::Size getFrameSize() const { return include_mask.size(); }
+    const cv::Mat& getIncludeMask() const { return include_mask; }   // 255 - обрабатывать
+    const std::vector<cv::Rect>& getTiles() const { return tiles; }  // тайлы, задевающие область
+    const cv::Rect& getBounds() const { return bounds; }             // охватывающий прямоугольник тайлов
+
+    static const int default_tile_size = 256;
+private:
+    void buildTiles(int tile_size);
+
+    cv::Mat include_mask;
+    std::vector<cv::Rect> tiles;
+    cv::Rect bounds;
+};
 
 class ShadowLedentifier {
 public:
+    // Время этапов последнего вызова processImage, мс
+    struct Timings {
+        double process_ms = 0.0; // сегментация
+        double encode_ms = 0.0;  // запись debug-изображений
+    };
+
     ShadowLedentifier(int v_thresh = 80, int s_thresh = 60, int morph_size = 7, int min_area = 500);
     // Основной метод обработки
     cv::Mat processImage(const cv::Mat& input, const std::string& outputPath = "");
+    // Обработка по тайлам с перекрытием: результат совпадает с processImage,
+    // но полноразмерными остаются только вход и маски. Debug-вывод - только 5_filtered.jpg
+    cv::Mat processImageTiled(const cv::Mat& input, const std::string& outputPath = "",
+                              int tile_size = default_tile_size);
+    // Обработка только внутри области: порог и морфология - по тайлам области
+    // (с перекрытием по соседним пикселям), разметка компонент - в пределах ее
+    // охватывающего прямоугольника. Стоимость пропорциональна площади области
+    cv::Mat processImage(const cv::Mat& input, const ProcessingRegion& region, const std::string& outputPath = "");
     // Метод для создания цветного результата
     cv::Mat createColoredMask(const cv::Mat& mask, const cv::Mat& original);
+    // Оценка пикового объема памяти на одно изображение, байт
+    size_t estimateWorkingSet(int width, int height, bool tiled, int tile_size = default_tile_size) const;
+    const Timings& getLastTimings() const { return last_timings; }
+
+    static const int default_tile_size = 1024;
 private:
+    // Перекрытие тайлов, при котором морфология внутри тайла точна
+    int morphologyHalo() const;
+    // Порог по V и морфология для области core (с перекрытием), результат размера core
+    cv::Mat segmentRegion(const cv::Mat& input, const cv::Rect& core) const;
+    // segmentRegion для каждого тайла; тайл пишется в mask со сдвигом на -origin
+    void segmentTiles(const cv::Mat& input, const std::vector<cv::Rect>& tiles, cv::Mat& mask,
+                      cv::Point origin = cv::Point()) const;
+    // Фильтрация компонент маски по площади
+    cv::Mat filterByArea(const cv::Mat& mask) const;
+
     int value_threshold;      // Порог яркости V для HSV
     int saturation_threshold; // Порог насыщенности S для HSV
     int morph_kernel_size;    // Размер морфологического ядра
     int min_shadow_area;      // Минимальная площадь тени
+    Timings last_timings;
 };
 
 #endif
@@ -58,7 +58,7 @@ if exist "debug_output" (
     for /d %%d in (debug_output\*) do (
         set /a folder_count+=1
         set /a file_count=0
-        for %%f in ("%%d\step*.jpg") do set /a file_count+=1
+        for %%f in ("%%d\*.jpg") do set /a file_count+=1
         echo   %%~nd: !file_count! steps
     )
     
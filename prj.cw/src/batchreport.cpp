@@ -0,0 +1,204 @@
+#include "batchreport.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+std::string escapeJson(const std::string& text) {
+    std::ostringstream out;
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+                        << std::dec << std::setfill(' ');
+                } else {
+                    out << c;
+                }
+        }
+    }
+    return out.str();
+}
+
+} // namespace
+
+void BatchReport::addRecord(const ImageRecord& record) {
+    records.push_back(record);
+}
+
+size_t BatchReport::peakRssBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<size_t>(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);          // байты
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;   // килобайты
+#endif
+#endif
+}
+
+BatchReport::Percentiles BatchReport::computePercentiles(std::vector<double> values) {
+    Percentiles result;
+    if (values.empty()) {
+        return result;
+    }
+    std::sort(values.begin(), values.end());
+    // Nearest-rank: наименьшее значение, покрывающее p% выборки
+    auto rank = [&values](double p) {
+        size_t index = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+        return values[std::min(values.size(), std::max<size_t>(index, 1)) - 1];
+    };
+    result.p50 = rank(50);
+    result.p90 = rank(90);
+    result.p99 = rank(99);
+    result.max = values.back();
+    return result;
+}
+
+std::vector<const ImageRecord*> BatchReport::slowest(size_t count) const {
+    std::vector<const ImageRecord*> sorted;
+    for (const auto& record : records) {
+        sorted.push_back(&record);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const ImageRecord* a, const ImageRecord* b) {
+        return a->totalMs() > b->totalMs();
+    });
+    if (sorted.size() > count) {
+        sorted.resize(count);
+    }
+    return sorted;
+}
+
+BatchReport::Summary BatchReport::summarize() const {
+    std::vector<double> decode, process, encode, total;
+    Summary summary;
+    for (const auto& record : records) {
+        decode.push_back(record.decode_ms);
+        process.push_back(record.process_ms);
+        encode.push_back(record.encode_ms);
+        total.push_back(record.totalMs());
+        summary.megapixels += record.megapixels();
+        if (record.ok) summary.succeeded++;
+    }
+    summary.decode = computePercentiles(decode);
+    summary.process = computePercentiles(process);
+    summary.encode = computePercentiles(encode);
+    summary.total = computePercentiles(total);
+    return summary;
+}
+
+void BatchReport::printSummary(std::ostream& out, double wall_ms) const {
+    Summary summary = summarize();
+    double wall_s = wall_ms / 1000.0;
+
+    out << std::fixed << std::setprecision(1);
+    out << "  Succeeded: " << summary.succeeded << "/" << records.size() << " images" << std::endl;
+    out << "  Wall time: " << wall_ms << " ms" << std::endl;
+    if (wall_s > 0) {
+        out << std::setprecision(2);
+        out << "  Throughput: " << records.size() / wall_s << " images/s, "
+            << summary.megapixels / wall_s << " MP/s" << std::endl;
+        out << std::setprecision(1);
+    }
+    out << "  Peak RSS: " << peakRssBytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+
+    out << "\n  Latency, ms       p50       p90       p99       max" << std::endl;
+    auto print_row = [&out](const std::string& name, const Percentiles& p) {
+        out << "  " << std::left << std::setw(12) << name << std::right
+            << std::setw(10) << p.p50 << std::setw(10) << p.p90
+            << std::setw(10) << p.p99 << std::setw(10) << p.max << std::endl;
+    };
+    print_row("decode", summary.decode);
+    print_row("process", summary.process);
+    print_row("encode", summary.encode);
+    print_row("total", summary.total);
+
+    out << "\n  Slowest files:" << std::endl;
+    for (const ImageRecord* record : slowest(slowest_count)) {
+        out << "  " << std::setw(10) << record->totalMs() << " ms  "
+            << record->width << "x" << record->height << "  " << record->path << std::endl;
+    }
+    out << std::defaultfloat;
+}
+
+bool BatchReport::writeJson(const std::string& path, double wall_ms) const {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    Summary summary = summarize();
+    double wall_s = wall_ms / 1000.0;
+
+    auto write_percentiles = [&file](const std::string& name, const Percentiles& p, bool last) {
+        file << "    \"" << name << "\": {\"p50\": " << p.p50 << ", \"p90\": " << p.p90
+             << ", \"p99\": " << p.p99 << ", \"max\": " << p.max << "}" << (last ? "\n" : ",\n");
+    };
+    auto write_record = [&file](const ImageRecord& r) {
+        file << "{\"path\": \"" << escapeJson(r.path) << "\", \"width\": " << r.width
+             << ", \"height\": " << r.height << ", \"decode_ms\": " << r.decode_ms
+             << ", \"process_ms\": " << r.process_ms << ", \"encode_ms\": " << r.encode_ms
+             << ", \"total_ms\": " << r.totalMs() << ", \"ok\": " << (r.ok ? "true" : "false")
+             << ", \"tiled\": " << (r.tiled ? "true" : "false")
+             << ", \"shadow_percentage\": " << r.shadow_percentage << "}";
+    };
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\n";
+    file << "  \"images\": " << records.size() << ",\n";
+    file << "  \"succeeded\": " << summary.succeeded << ",\n";
+    file << "  \"wall_ms\": " << wall_ms << ",\n";
+    file << "  \"images_per_s\": " << (wall_s > 0 ? records.size() / wall_s : 0.0) << ",\n";
+    file << "  \"megapixels_per_s\": " << (wall_s > 0 ? summary.megapixels / wall_s : 0.0) << ",\n";
+    file << "  \"peak_rss_bytes\": " << peakRssBytes() << ",\n";
+    file << "  \"latency_ms\": {\n";
+    write_percentiles("decode", summary.decode, false);
+    write_percentiles("process", summary.process, false);
+    write_percentiles("encode", summary.encode, false);
+    write_percentiles("total", summary.total, true);
+    file << "  },\n";
+
+    file << "  \"slowest\": [\n";
+    std::vector<const ImageRecord*> top = slowest(slowest_count);
+    for (size_t i = 0; i < top.size(); ++i) {
+        file << "    ";
+        write_record(*top[i]);
+        file << (i + 1 < top.size() ? ",\n" : "\n");
+    }
+    file << "  ],\n";
+
+    file << "  \"records\": [\n";
+    for (size_t i = 0; i < records.size(); ++i) {
+        file << "    ";
+        write_record(records[i]);
+        file << (i + 1 < records.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n";
+    file << "}\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,277 @@
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include "shadowledentifier.h"
+
+using namespace cv;
+using namespace std;
+
+// Оценка качества масок и скорости детектора на размеченном наборе:
+//   dataset/images/<name>.jpg - входные изображения
+//   dataset/masks/<name>.png  - эталонные маски теней (ненулевые пиксели - тень)
+
+struct EvalConfig {
+    string name;
+    int v_thresh;
+    int s_thresh;
+    int morph_size;
+    int min_area;
+};
+
+enum class SpeedMode { Full, Tiled, Pyramid };
+
+struct Sample {
+    string name;
+    Mat image;
+    Mat truth;
+};
+
+struct EvalResult {
+    string config;
+    string mode;
+    double mean_iou = 0.0;
+    double mean_f1 = 0.0;
+    double mean_ms = 0.0;
+    double p50_ms = 0.0;
+    double p90_ms = 0.0;
+    bool pareto = false;
+};
+
+const char* modeName(SpeedMode mode) {
+    switch (mode) {
+        case SpeedMode::Full: return "full";
+        case SpeedMode::Tiled: return "tiled";
+        case SpeedMode::Pyramid: return "pyramid";
+    }
+    return "";
+}
+
+vector<Sample> loadDataset(const string& root) {
+    vector<Sample> samples;
+    vector<string> extensions = {".jpg", ".jpeg", ".png", ".bmp"};
+    vector<filesystem::path> images;
+    try {
+        for (const auto& entry : filesystem::directory_iterator(filesystem::path(root) / "images")) {
+            string file_ext = entry.path().extension().string();
+            transform(file_ext.begin(), file_ext.end(), file_ext.begin(),
+                [](unsigned char c){ return std::tolower(c); });
+            if (entry.is_regular_file() && find(extensions.begin(), extensions.end(), file_ext) != extensions.end()) {
+                images.push_back(entry.path());
+            }
+        }
+    } catch (const exception& e) {
+        cerr << "Error accessing dataset: " << e.what() << endl;
+        return samples;
+    }
+    sort(images.begin(), images.end());
+
+    for (const auto& image_path : images) {
+        string stem = image_path.stem().string();
+        filesystem::path mask_path;
+        for (const string& ext : extensions) {
+            filesystem::path candidate = filesystem::path(root) / "masks" / (stem + ext);
+            if (filesystem::exists(candidate)) {
+                mask_path = candidate;
+                break;
+            }
+        }
+        if (mask_path.empty()) {
+            cerr << "  [SKIP] No ground-truth mask for " << image_path.filename().string() << endl;
+            continue;
+        }
+        Sample sample;
+        sample.name = stem;
+        sample.image = imread(image_path.string());
+        Mat truth = imread(mask_path.string(), IMREAD_GRAYSCALE);
+        if (sample.image.empty() || truth.empty() || truth.size() != sample.image.size()) {
+            cerr << "  [SKIP] Cannot load " << stem << " or mask size mismatch" << endl;
+            continue;
+        }
+        sample.truth = truth > 127;
+        samples.push_back(sample);
+    }
+    return samples;
+}
+
+// IoU и F1 маски относительно эталона
+void compareMasks(const Mat& predicted, const Mat& truth, double& iou, double& f1) {
+    Mat pred = predicted > 127;
+    double tp = countNonZero(pred & truth);
+    double fp = countNonZero(pred & ~truth);
+    double fn = countNonZero(~pred & truth);
+    double union_area = tp + fp + fn;
+    // Пустые маски с обеих сторон - полное совпадение
+    iou = union_area > 0 ? tp / union_area : 1.0;
+    f1 = union_area > 0 ? 2 * tp / (2 * tp + fp + fn) : 1.0;
+}
+
+Mat runMode(ShadowLedentifier& detector, ShadowLedentifier& half_detector, const Mat& image, SpeedMode mode) {
+    switch (mode) {
+        case SpeedMode::Full:
+            return detector.processImage(image);
+        case SpeedMode::Tiled:
+            return detector.processImageTiled(image);
+        case SpeedMode::Pyramid: {
+            // Обработка на половинном разрешении, маска возвращается к исходному размеру
+            Mat half, mask;
+            pyrDown(image, half);
+            resize(half_detector.processImage(half), mask, image.size(), 0, 0, INTER_NEAREST);
+            return mask;
+        }
+    }
+    return Mat();
+}
+
+double percentile(vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(ceil(p / 100.0 * values.size()));
+    return values[min(values.size(), max<size_t>(index, 1)) - 1];
+}
+
+EvalResult evaluate(const EvalConfig& config, SpeedMode mode, const vector<Sample>& samples, int repeat) {
+    ShadowLedentifier detector(config.v_thresh, config.s_thresh, config.morph_size, config.min_area);
+    // На половинном разрешении ядро и минимальная площадь уменьшаются пропорционально
+    ShadowLedentifier half_detector(config.v_thresh, config.s_thresh,
+                                    max(3, (config.morph_size / 2) | 1), config.min_area / 4);
+    EvalResult result;
+    result.config = config.name;
+    result.mode = modeName(mode);
+
+    vector<double> latencies;
+    for (const Sample& sample : samples) {
+        Mat mask;
+        vector<double> runs;
+        for (int r = 0; r < repeat; ++r) {
+            auto start = chrono::steady_clock::now();
+            mask = runMode(detector, half_detector, sample.image, mode);
+            runs.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        }
+        double iou = 0.0, f1 = 0.0;
+        compareMasks(mask, sample.truth, iou, f1);
+        result.mean_iou += iou;
+        result.mean_f1 += f1;
+        latencies.push_back(percentile(runs, 50));
+    }
+    if (!samples.empty()) {
+        result.mean_iou /= samples.size();
+        result.mean_f1 /= samples.size();
+    }
+    for (double ms : latencies) result.mean_ms += ms;
+    result.mean_ms /= max<size_t>(latencies.size(), 1);
+    result.p50_ms = percentile(latencies, 50);
+    result.p90_ms = percentile(latencies, 90);
+    return result;
+}
+
+// Точка Парето: нет другой, которая не хуже по F1 и задержке и строго лучше хотя бы в одном
+void markPareto(vector<EvalResult>& results) {
+    for (auto& a : results) {
+        a.pareto = true;
+        for (const auto& b : results) {
+            bool not_worse = b.mean_f1 >= a.mean_f1 && b.mean_ms <= a.mean_ms;
+            bool better = b.mean_f1 > a.mean_f1 || b.mean_ms < a.mean_ms;
+            if (not_worse && better) {
+                a.pareto = false;
+                break;
+            }
+        }
+    }
+}
+
+void printUsage(const char* program) {
+    cout << "Usage: " << program << " <dataset_dir> [--repeat N] [--csv report.csv]" << endl;
+    cout << "  dataset_dir/images/<name>.jpg  input images" << endl;
+    cout << "  dataset_dir/masks/<name>.png   ground-truth shadow masks" << endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return -1;
+    }
+    string dataset = argv[1];
+    string csv_path;
+    int repeat = 3;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) {
+            try { repeat = stoi(argv[++i]); } catch (...) { repeat = 0; }
+            if (repeat < 1) {
+                cerr << "ERROR: Invalid --repeat value" << endl;
+                return -1;
+            }
+        } else if (arg == "--csv" && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return -1;
+        }
+    }
+
+    vector<Sample> samples = loadDataset(dataset);
+    if (samples.empty()) {
+        cerr << "No images with ground-truth masks found in " << dataset << endl;
+        return -1;
+    }
+    cout << "Loaded " << samples.size() << " images with ground truth" << endl;
+
+    vector<EvalConfig> configs = {
+        {"default",  80, 60, 7, 500},
+        {"v60",      60, 60, 7, 500},
+        {"v100",    100, 60, 7, 500},
+        {"morph5",   80, 60, 5, 500},
+        {"morph9",   80, 60, 9, 500},
+        {"area2000", 80, 60, 7, 2000},
+    };
+    vector<SpeedMode> modes = {SpeedMode::Full, SpeedMode::Tiled, SpeedMode::Pyramid};
+
+    vector<EvalResult> results;
+    for (const auto& config : configs) {
+        for (SpeedMode mode : modes) {
+            cout << "  Evaluating " << config.name << " / " << modeName(mode) << "..." << endl;
+            results.push_back(evaluate(config, mode, samples, repeat));
+        }
+    }
+    markPareto(results);
+    sort(results.begin(), results.end(), [](const EvalResult& a, const EvalResult& b) {
+        return a.mean_ms < b.mean_ms;
+    });
+
+    cout << "\n" << string(78, '=') << endl;
+    cout << left << setw(12) << "config" << setw(10) << "mode" << right
+         << setw(10) << "IoU" << setw(10) << "F1" << setw(12) << "mean ms"
+         << setw(12) << "p50 ms" << setw(12) << "p90 ms" << endl;
+    cout << string(78, '-') << endl;
+    cout << fixed;
+    for (const auto& r : results) {
+        cout << left << setw(12) << r.config << setw(10) << r.mode << right
+             << setprecision(4) << setw(10) << r.mean_iou << setw(10) << r.mean_f1
+             << setprecision(2) << setw(12) << r.mean_ms << setw(12) << r.p50_ms << setw(12) << r.p90_ms
+             << (r.pareto ? "  *" : "") << endl;
+    }
+    cout << string(78, '=') << endl;
+    cout << "* - Pareto-optimal (F1 vs. mean latency)" << endl;
+
+    if (!csv_path.empty()) {
+        ofstream csv(csv_path);
+        csv << "config,mode,iou,f1,mean_ms,p50_ms,p90_ms,pareto\n";
+        csv << fixed << setprecision(4);
+        for (const auto& r : results) {
+            csv << r.config << "," << r.mode << "," << r.mean_iou << "," << r.mean_f1 << ","
+                << r.mean_ms << "," << r.p50_ms << "," << r.p90_ms << "," << (r.pareto ? 1 : 0) << "\n";
+        }
+        if (!csv) {
+            cerr << "ERROR: Failed to write " << csv_path << endl;
+            return -1;
+        }
+        cout << "Report saved to: " << csv_path << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,282 @@
+#include "framestream.h"
+#include "shadowledentifier.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+
+// Очередь фиксированной емкости между стадиями конвейера
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // false - очередь закрыта и пуста
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+private:
+    size_t capacity;
+    bool closed = false;
+    std::deque<T> items;
+    std::mutex mutex;
+    std::condition_variable not_empty, not_full;
+};
+
+// Число буферов на каждой стадии: пока один обрабатывается, второй заполняется
+const size_t buffer_count = 2;
+
+// Кадр читается частями, чтобы читатель между вызовами fread замечал остановку конвейера
+const size_t read_chunk = size_t(1) << 20;
+
+// Возвращает число прочитанных байт: меньше size при конце потока или остановке
+size_t readFrame(std::FILE* in, uchar* data, size_t size, const std::atomic<bool>& aborted) {
+    size_t done = 0;
+    while (done < size && !aborted) {
+        size_t part = std::min(read_chunk, size - done);
+        size_t got = std::fread(data + done, 1, part, in);
+        done += got;
+        if (got != part) break;
+    }
+    return done;
+}
+
+bool readLine(std::FILE* in, std::string& line) {
+    line.clear();
+    int c;
+    while ((c = std::fgetc(in)) != EOF) {
+        if (c == '\n') return true;
+        line.push_back(static_cast<char>(c));
+        if (line.size() > 4096) return false;
+    }
+    return false;
+}
+
+// Заголовок YUV4MPEG2: "YUV4MPEG2 W<w> H<h> [F..] [I..] [A..] [C<colorspace>]"
+bool parseY4mHeader(const std::string& line, int& width, int& height, bool& mono) {
+    std::istringstream tokens(line);
+    std::string token;
+    tokens >> token;
+    if (token != "YUV4MPEG2") return false;
+
+    std::string colorspace = "420";
+    try {
+        while (tokens >> token) {
+            if (token[0] == 'W') width = std::stoi(token.substr(1));
+            else if (token[0] == 'H') height = std::stoi(token.substr(1));
+            else if (token[0] == 'C') colorspace = token.substr(1);
+        }
+    } catch (...) {
+        return false;
+    }
+
+    if (colorspace.rfind("420", 0) == 0) {
+        mono = false;
+    } else if (colorspace == "mono") {
+        mono = true;
+    } else {
+        std::cerr << "ERROR: Unsupported Y4M colorspace C" << colorspace << " (expected C420* or Cmono)" << std::endl;
+        return false;
+    }
+    return width > 0 && height > 0 && (mono || (width % 2 == 0 && height % 2 == 0));
+}
+
+} // namespace
+
+void packMask(const cv::Mat& mask, std::vector<uchar>& packed) {
+    const int row_bytes = (mask.cols + 7) / 8;
+    packed.assign(static_cast<size_t>(row_bytes) * mask.rows, 0);
+    for (int y = 0; y < mask.rows; ++y) {
+        const uchar* src = mask.ptr<uchar>(y);
+        uchar* dst = packed.data() + static_cast<size_t>(y) * row_bytes;
+        for (int x = 0; x < mask.cols; ++x) {
+            if (src[x]) {
+                dst[x >> 3] |= static_cast<uchar>(0x80 >> (x & 7));
+            }
+        }
+    }
+}
+
+int runStreaming(const StreamOptions& options) {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    int width = options.width;
+    int height = options.height;
+    bool y4m = options.input == StreamInput::Y4m;
+    bool mono = false;
+
+    if (y4m) {
+        std::string header;
+        int y4m_width = 0, y4m_height = 0;
+        if (!readLine(stdin, header) || !parseY4mHeader(header, y4m_width, y4m_height, mono)) {
+            std::cerr << "ERROR: Invalid Y4M stream header" << std::endl;
+            return -1;
+        }
+        if ((width > 0 || height > 0) && (width != y4m_width || height != y4m_height)) {
+            std::cerr << "WARNING: Declared size " << width << "x" << height << " differs from Y4M header "
+                      << y4m_width << "x" << y4m_height << ", using the header" << std::endl;
+        }
+        width = y4m_width;
+        height = y4m_height;
+    }
+    if (width <= 0 || height <= 0) {
+        std::cerr << "ERROR: Frame size is required for raw BGR24 input (--size WxH)" << std::endl;
+        return -1;
+    }
+
+    ProcessingRegion region;
+    if (!options.exclusion_mask.empty()) {
+        region = ProcessingRegion::fromExclusionMaskFile(options.exclusion_mask);
+        if (region.empty()) return -1;
+        if (region.getFrameSize() != cv::Size(width, height)) {
+            std::cerr << "ERROR: Exclusion mask size does not match the frame size" << std::endl;
+            return -1;
+        }
+    }
+
+    // Буферы выделяются один раз и переходят по кругу между стадиями
+    BoundedQueue<cv::Mat> free_inputs(buffer_count), ready_inputs(buffer_count);
+    BoundedQueue<std::vector<uchar>> free_outputs(buffer_count), ready_outputs(buffer_count);
+    for (size_t i = 0; i < buffer_count; ++i) {
+        if (!y4m) {
+            free_inputs.push(cv::Mat(height, width, CV_8UC3));
+        } else if (mono) {
+            free_inputs.push(cv::Mat(height, width, CV_8UC1));
+        } else {
+            free_inputs.push(cv::Mat(height * 3 / 2, width, CV_8UC1)); // I420: Y, затем U и V
+        }
+        free_outputs.push(std::vector<uchar>());
+    }
+
+    std::atomic<bool> write_failed(false);
+    std::atomic<bool> aborted(false);
+    auto abort_pipeline = [&]() {
+        aborted = true;
+        free_inputs.close();
+        ready_inputs.close();
+        free_outputs.close();
+        ready_outputs.close();
+    };
+
+    // Читатель завершается при закрытии очередей или по флагу aborted, поэтому его всегда можно дождаться
+    std::thread reader([&]() {
+        cv::Mat buffer;
+        while (!aborted && free_inputs.pop(buffer)) {
+            if (y4m) {
+                std::string frame_header;
+                if (!readLine(stdin, frame_header) || frame_header.rfind("FRAME", 0) != 0) break;
+            }
+            const size_t frame_bytes = buffer.total() * buffer.elemSize();
+            const size_t got = readFrame(stdin, buffer.data, frame_bytes, aborted);
+            if (got != frame_bytes) {
+                if (got > 0 && !aborted) {
+                    std::cerr << "WARNING: Truncated final frame dropped (" << got << " of " << frame_bytes
+                              << " bytes)" << std::endl;
+                }
+                break;
+            }
+            if (!ready_inputs.push(buffer)) break;
+        }
+        ready_inputs.close();
+    });
+
+    std::thread writer([&]() {
+        std::vector<uchar> buffer;
+        while (ready_outputs.pop(buffer)) {
+            if (std::fwrite(buffer.data(), 1, buffer.size(), stdout) != buffer.size() || std::fflush(stdout) != 0) {
+                write_failed = true;
+                abort_pipeline();
+                break;
+            }
+            if (!free_outputs.push(std::move(buffer))) break;
+        }
+    });
+
+    ShadowLedentifier detector;
+    cv::Mat frame, bgr;
+    std::vector<uchar> output;
+    long long frames = 0;
+    bool process_failed = false;
+    auto start = std::chrono::steady_clock::now();
+    while (ready_inputs.pop(frame)) {
+        const cv::Mat* color = &frame;
+        if (y4m) {
+            cv::cvtColor(frame, bgr, mono ? cv::COLOR_GRAY2BGR : cv::COLOR_YUV2BGR_I420);
+            color = &bgr;
+        }
+        cv::Mat mask = region.empty() ? detector.processImage(*color) : detector.processImage(*color, region);
+        if (mask.empty()) {
+            process_failed = true;
+            break;
+        }
+        if (!free_inputs.push(frame) || !free_outputs.pop(output)) break;
+
+        if (options.output == StreamOutput::Packed) {
+            packMask(mask, output);
+        } else {
+            output.assign(mask.data, mask.data + mask.total());
+        }
+        if (!ready_outputs.push(std::move(output))) break;
+        frames++;
+    }
+    if (process_failed) {
+        abort_pipeline();
+    }
+    ready_outputs.close();
+    writer.join();
+
+    // Очереди и буферы принадлежат этой функции, поэтому оба потока дожидаются на любом пути
+    if (write_failed || process_failed) {
+        abort_pipeline();
+    }
+    reader.join();
+    if (write_failed || process_failed) {
+        std::cerr << (write_failed ? "ERROR: Failed to write to stdout" : "ERROR: Frame processing failed") << std::endl;
+        return -1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Streamed " << frames << " frames (" << width << "x" << height << ")";
+    if (seconds > 0) {
+        std::cerr << ", " << frames / seconds << " fps";
+    }
+    std::cerr << std::endl;
+    return 0;
+}
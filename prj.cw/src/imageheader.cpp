@@ -0,0 +1,98 @@
+#include "imageheader.h"
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+
+uint32_t readBigEndian(const unsigned char* p, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+uint32_t readLittleEndian(const unsigned char* p, int bytes) {
+    uint32_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+bool readPng(std::ifstream& file, ImageHeader& header) {
+    // Сигнатура (8 байт), длина и тип чанка IHDR (8 байт), затем его данные
+    unsigned char buf[26];
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(buf), sizeof(buf))) return false;
+    if (readBigEndian(buf + 12, 4) != 0x49484452) return false; // "IHDR"
+    header.width = static_cast<int>(readBigEndian(buf + 16, 4));
+    header.height = static_cast<int>(readBigEndian(buf + 20, 4));
+    // Допустимые типы цвета: gray, RGB, палитра, gray + alpha, RGBA
+    const unsigned char color_type = buf[25];
+    return color_type == 0 || color_type == 2 || color_type == 3 || color_type == 4 || color_type == 6;
+}
+
+bool readJpeg(std::ifstream& file, ImageHeader& header) {
+    file.seekg(2);
+    unsigned char marker[2];
+    while (file.read(reinterpret_cast<char*>(marker), 2)) {
+        if (marker[0] != 0xFF) return false;
+        unsigned char type = marker[1];
+        // Заполняющие байты 0xFF и маркеры без длины
+        if (type == 0xFF) {
+            file.seekg(-1, std::ios::cur);
+            continue;
+        }
+        if (type == 0x01 || (type >= 0xD0 && type <= 0xD9)) continue;
+
+        unsigned char length_buf[2];
+        if (!file.read(reinterpret_cast<char*>(length_buf), 2)) return false;
+        uint32_t length = readBigEndian(length_buf, 2);
+        if (length < 2) return false;
+
+        // SOF0..SOF15, кроме DHT (C4), JPG (C8) и DAC (CC)
+        bool is_sof = type >= 0xC0 && type <= 0xCF && type != 0xC4 && type != 0xC8 && type != 0xCC;
+        if (is_sof) {
+            unsigned char sof[5];
+            if (!file.read(reinterpret_cast<char*>(sof), sizeof(sof))) return false;
+            header.height = static_cast<int>(readBigEndian(sof + 1, 2));
+            header.width = static_cast<int>(readBigEndian(sof + 3, 2));
+            return true;
+        }
+        if (type == 0xDA) return false; // начались данные, SOF не найден
+        file.seekg(length - 2, std::ios::cur);
+    }
+    return false;
+}
+
+bool readBmp(std::ifstream& file, ImageHeader& header) {
+    unsigned char buf[26];
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(buf), sizeof(buf))) return false;
+    header.width = static_cast<int32_t>(readLittleEndian(buf + 18, 4));
+    header.height = std::abs(static_cast<int32_t>(readLittleEndian(buf + 22, 4)));
+    return true;
+}
+
+} // namespace
+
+bool readImageHeader(const std::string& path, ImageHeader& header) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    unsigned char magic[4] = {0, 0, 0, 0};
+    if (!file.read(reinterpret_cast<char*>(magic), sizeof(magic))) return false;
+
+    header = ImageHeader();
+    bool ok = false;
+    if (magic[0] == 0x89 && magic[1] == 'P' && magic[2] == 'N' && magic[3] == 'G') {
+        ok = readPng(file, header);
+    } else if (magic[0] == 0xFF && magic[1] == 0xD8) {
+        ok = readJpeg(file, header);
+    } else if (magic[0] == 'B' && magic[1] == 'M') {
+        ok = readBmp(file, header);
+    }
+    return ok && header.width > 0 && header.height > 0;
+}
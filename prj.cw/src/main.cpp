@@ -6,13 +6,27 @@
 #include <iomanip>
 #include <chrono>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include "shadowledentifier.h"
+#include "batchreport.h"
+#include "imageheader.h"
+#include "memorybudget.h"
+#include "framestream.h"
 
 using namespace cv;
 using namespace std;
 
+// Параметры пакетной обработки
+struct BatchOptions {
+    size_t max_memory = 0; // бюджет памяти, байт (0 - без ограничения)
+    int jobs = 0;          // число потоков (0 - по числу ядер)
+};
+
 // Функция для пакетной обработки изображений из папки examples
-int batchProcessing() {
+int batchProcessing(const BatchOptions& options) {
     cout << "\n" << string(60, '=') << endl;
     cout << "    BATCH PROCESSING MODE - DEBUG OUTPUT" << endl;
     cout << string(60, '=') << endl;
@@ -47,54 +61,130 @@ int batchProcessing() {
 
     cout << "Found " << image_files.size() << " images for processing\n" << endl;
 
-    ShadowLedentifier detector;
+    int jobs = options.jobs > 0 ? options.jobs : static_cast<int>(thread::hardware_concurrency());
+    jobs = max(1, min(jobs, static_cast<int>(image_files.size())));
+    MemoryBudget budget(options.max_memory);
+    cout << "Workers: " << jobs << ", memory budget: ";
+    if (budget.isLimited()) {
+        cout << budget.getLimit() / (1024 * 1024) << " MB" << endl;
+    } else {
+        cout << "unlimited" << endl;
+    }
+    cout << endl;
+
+    BatchReport report;
     int processed = 0;
+    mutex output_mutex;
+    atomic<size_t> next_image(0);
+    auto elapsed_ms = [](chrono::steady_clock::time_point since) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
+    };
+    auto batch_start = chrono::steady_clock::now();
 
-    for (const string& image_path : image_files) {
-        processed++;
-        cout << "[" << processed << "/" << image_files.size() << "] Processing: " 
-             << filesystem::path(image_path).filename().string() << endl;
+    auto worker = [&]() {
+        ShadowLedentifier detector;
+        while (true) {
+            size_t index = next_image++;
+            if (index >= image_files.size()) break;
+            const string& image_path = image_files[index];
 
-        Mat input = imread(image_path);
-        if (input.empty()) {
-            cout << "  ✗ Failed to load image" << endl;
-            continue;
-        }
+            ImageRecord record;
+            record.path = image_path;
+            ostringstream log;
+            log << fixed << setprecision(1);
 
-        string image_name = filesystem::path(image_path).stem().string();
-        string debug_path = "debug_output/" + image_name;
-        cout << "  [DEBUG] Output path: " << debug_path << endl;
+            // Working set is estimated from the header before decoding. Images that
+            // do not fit the budget take the tiled path; unknown formats reserve
+            // the whole budget so they run alone.
+            size_t estimate = budget.getLimit();
+            ImageHeader header;
+            if (readImageHeader(image_path, header)) {
+                estimate = detector.estimateWorkingSet(header.width, header.height, false);
+                if (budget.isLimited() && estimate > budget.getLimit()) {
+                    record.tiled = true;
+                    estimate = detector.estimateWorkingSet(header.width, header.height, true);
+                }
+            }
+            budget.acquire(estimate);
 
-        auto start_time = chrono::high_resolution_clock::now();
-        Mat shadow_mask = detector.processImage(input, debug_path);
-        auto end_time = chrono::high_resolution_clock::now();
-        auto duration = chrono::duration_cast<chrono::milliseconds>(end_time - start_time);
+            auto decode_start = chrono::steady_clock::now();
+            Mat input = imread(image_path);
+            record.decode_ms = elapsed_ms(decode_start);
 
-        // Check that at least one file is created
-        bool debug_ok = false;
-        try {
-            debug_ok = std::filesystem::exists(debug_path + "/step5_area_filtered.jpg");
-        } catch (...) {
-            debug_ok = false;
-        }
-        if (!shadow_mask.empty() && debug_ok) {
-            int total_pixels = shadow_mask.rows * shadow_mask.cols;
-            int shadow_pixels = countNonZero(shadow_mask);
-            double shadow_percentage = (double)shadow_pixels / total_pixels * 100;
+            if (input.empty()) {
+                log << "  ✗ Failed to load image" << endl;
+            } else {
+                record.width = input.cols;
+                record.height = input.rows;
 
-            cout << "  ✓ Processed in " << duration.count() << " ms" << endl;
-            cout << "  ✓ Shadow coverage: " << fixed << setprecision(1) << shadow_percentage << "%" << endl;
-            cout << "  ✓ Debug output saved to: " << debug_path << endl;
-        } else {
-            cout << "  ✗ Processing failed or debug output not created!" << endl;
+                string image_name = filesystem::path(image_path).stem().string();
+                string debug_path = "debug_output/" + image_name;
+                log << "  [DEBUG] Output path: " << debug_path << endl;
+
+                Mat shadow_mask = record.tiled ? detector.processImageTiled(input, debug_path)
+                                               : detector.processImage(input, debug_path);
+                record.process_ms = detector.getLastTimings().process_ms;
+                record.encode_ms = detector.getLastTimings().encode_ms;
+
+                // Check that at least one file is created
+                bool debug_ok = false;
+                try {
+                    debug_ok = std::filesystem::exists(debug_path + "/5_filtered.jpg");
+                } catch (...) {
+                    debug_ok = false;
+                }
+                if (!shadow_mask.empty() && debug_ok) {
+                    int total_pixels = shadow_mask.rows * shadow_mask.cols;
+                    int shadow_pixels = countNonZero(shadow_mask);
+                    double shadow_percentage = (double)shadow_pixels / total_pixels * 100;
+                    record.ok = true;
+                    record.shadow_percentage = shadow_percentage;
+
+                    log << "  ✓ Processed in " << record.totalMs() << " ms"
+                        << " (decode " << record.decode_ms << ", process " << record.process_ms
+                        << ", encode " << record.encode_ms << ")" << (record.tiled ? " [tiled]" : "") << endl;
+                    log << "  ✓ Shadow coverage: " << shadow_percentage << "%" << endl;
+                    log << "  ✓ Debug output saved to: " << debug_path << endl;
+                } else {
+                    log << "  ✗ Processing failed or debug output not created!" << endl;
+                }
+            }
+            input.release();
+            budget.release(estimate);
+
+            lock_guard<mutex> lock(output_mutex);
+            processed++;
+            cout << "[" << processed << "/" << image_files.size() << "] Processing: "
+                 << filesystem::path(image_path).filename().string() << endl;
+            cout << log.str() << endl;
+            report.addRecord(record);
         }
-        cout << endl;
+    };
+
+    vector<thread> workers;
+    for (int i = 0; i < jobs; ++i) {
+        workers.emplace_back(worker);
     }
+    for (auto& t : workers) {
+        t.join();
+    }
+    double wall_ms = elapsed_ms(batch_start);
 
     cout << string(60, '=') << endl;
     cout << "  BATCH PROCESSING COMPLETED" << endl;
     cout << "  Processed: " << processed << "/" << image_files.size() << " images" << endl;
-    cout << "  Debug output located in: debug_output/" << endl;
+    report.printSummary(cout, wall_ms);
+    if (budget.isLimited()) {
+        cout << "  Peak admitted estimate: " << budget.getPeakInUse() / (1024.0 * 1024.0)
+             << " MB of " << budget.getLimit() / (1024.0 * 1024.0) << " MB budget" << endl;
+    }
+    cout << "\n  Debug output located in: debug_output/" << endl;
+    string report_path = "debug_output/batch_report.json";
+    if (report.writeJson(report_path, wall_ms)) {
+        cout << "  Report saved to: " << report_path << endl;
+    } else {
+        cout << "  [ERROR] Failed to write report: " << report_path << endl;
+    }
     cout << string(60, '=') << endl;
 
     // Check that debug_output folder is not empty
@@ -254,8 +344,59 @@ void processAndShow(const string& image_path) {
 }
 
 int main(int argc, char** argv) {
-    if (argc == 2 && string(argv[1]) == "--batch") {
-        return batchProcessing();
+    if (argc >= 2 && string(argv[1]) == "--stream") {
+        StreamOptions options;
+        for (int i = 2; i < argc; ++i) {
+            string arg = argv[i];
+            if (arg == "--size" && i + 1 < argc) {
+                string size = argv[++i];
+                size_t x_pos = size.find('x');
+                try {
+                    options.width = stoi(size.substr(0, x_pos));
+                    options.height = stoi(size.substr(x_pos + 1));
+                } catch (...) {
+                    options.width = options.height = 0;
+                }
+                if (x_pos == string::npos || options.width <= 0 || options.height <= 0) {
+                    cerr << "ERROR: Invalid --size value '" << size << "'" << endl;
+                    return -1;
+                }
+            } else if (arg == "--y4m") {
+                options.input = StreamInput::Y4m;
+            } else if (arg == "--packed") {
+                options.output = StreamOutput::Packed;
+            } else if (arg == "--exclude-mask" && i + 1 < argc) {
+                options.exclusion_mask = argv[++i];
+            } else {
+                cerr << "ERROR: Unknown stream option '" << arg << "'" << endl;
+                cerr << "Usage: " << argv[0] << " --stream (--size WxH | --y4m) [--packed] [--exclude-mask <path>]" << endl;
+                return -1;
+            }
+        }
+        return runStreaming(options);
+    }
+    if (argc >= 2 && string(argv[1]) == "--batch") {
+        BatchOptions options;
+        for (int i = 2; i < argc; ++i) {
+            string arg = argv[i];
+            if (arg == "--max-memory" && i + 1 < argc) {
+                if (!MemoryBudget::parseSize(argv[++i], options.max_memory)) {
+                    cerr << "ERROR: Invalid --max-memory value '" << argv[i] << "'" << endl;
+                    return -1;
+                }
+            } else if (arg == "--jobs" && i + 1 < argc) {
+                try { options.jobs = stoi(argv[++i]); } catch (...) { options.jobs = 0; }
+                if (options.jobs < 1) {
+                    cerr << "ERROR: Invalid --jobs value '" << argv[i] << "'" << endl;
+                    return -1;
+                }
+            } else {
+                cerr << "ERROR: Unknown batch option '" << arg << "'" << endl;
+                cerr << "Usage: " << argv[0] << " --batch [--max-memory <size>[K|M|G]] [--jobs <N>]" << endl;
+                return -1;
+            }
+        }
+        return batchProcessing(options);
     }
     while (true) {
         string image_path;
@@ -0,0 +1,54 @@
+#include "memorybudget.h"
+#include <algorithm>
+#include <cctype>
+
+MemoryBudget::MemoryBudget(size_t limit_bytes) : limit(limit_bytes) {}
+
+void MemoryBudget::acquire(size_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (limit > 0) {
+        released.wait(lock, [this, bytes] {
+            return active == 0 || in_use + bytes <= limit;
+        });
+    }
+    in_use += bytes;
+    active++;
+    peak_in_use = std::max(peak_in_use, in_use);
+}
+
+void MemoryBudget::release(size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        in_use -= std::min(in_use, bytes);
+        active--;
+    }
+    released.notify_all();
+}
+
+size_t MemoryBudget::getPeakInUse() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return peak_in_use;
+}
+
+bool MemoryBudget::parseSize(const std::string& text, size_t& bytes) {
+    size_t pos = 0;
+    double value = 0.0;
+    try {
+        value = std::stod(text, &pos);
+    } catch (...) {
+        return false;
+    }
+    if (value <= 0) return false;
+
+    double multiplier = 1024.0 * 1024.0;
+    std::string suffix = text.substr(pos);
+    std::transform(suffix.begin(), suffix.end(), suffix.begin(),
+        [](unsigned char c){ return std::toupper(c); });
+    if (suffix == "K" || suffix == "KB") multiplier = 1024.0;
+    else if (suffix.empty() || suffix == "M" || suffix == "MB") multiplier = 1024.0 * 1024.0;
+    else if (suffix == "G" || suffix == "GB") multiplier = 1024.0 * 1024.0 * 1024.0;
+    else return false;
+
+    bytes = static_cast<size_t>(value * multiplier);
+    return true;
+}
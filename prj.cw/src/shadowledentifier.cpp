@@ -2,10 +2,79 @@
 #include <iostream>
 #include <vector>
 #include <numeric>
+#include <chrono>
 #include <filesystem>
+#include <algorithm>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
 
+namespace {
+
+double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+void prepareOutputDir(const std::string& outputPath) {
+    std::error_code ec;
+    std::filesystem::create_directories(outputPath, ec);
+    if (ec) {
+        std::cerr << "[ERROR] Failed to create directory: " << outputPath << "\n";
+    }
+}
+
+void safeWrite(const std::string& path, const cv::Mat& img) {
+    if (!cv::imwrite(path, img)) {
+        std::cerr << "[ERROR] Failed to write: " << path << std::endl;
+    }
+}
+
+} // namespace
+
+ProcessingRegion::ProcessingRegion(cv::Size frame_size, const std::vector<cv::Rect>& rois, int tile_size) {
+    include_mask = cv::Mat::zeros(frame_size, CV_8UC1);
+    cv::Rect frame(cv::Point(0, 0), frame_size);
+    for (const auto& roi : rois) {
+        include_mask(roi & frame).setTo(255);
+    }
+    buildTiles(tile_size);
+}
+
+ProcessingRegion::ProcessingRegion(const cv::Mat& exclusion_mask, int tile_size) {
+    if (exclusion_mask.empty()) {
+        return;
+    }
+    cv::Mat gray = exclusion_mask;
+    if (gray.channels() != 1) {
+        cv::cvtColor(exclusion_mask, gray, cv::COLOR_BGR2GRAY);
+    }
+    cv::threshold(gray, include_mask, 0, 255, cv::THRESH_BINARY_INV);
+    buildTiles(tile_size);
+}
+
+ProcessingRegion ProcessingRegion::fromExclusionMaskFile(const std::string& path, int tile_size) {
+    cv::Mat mask = cv::imread(path, cv::IMREAD_GRAYSCALE);
+    if (mask.empty()) {
+        std::cerr << "ERROR: Cannot load exclusion mask '" << path << "'" << std::endl;
+        return ProcessingRegion();
+    }
+    return ProcessingRegion(mask, tile_size);
+}
+
+void ProcessingRegion::buildTiles(int tile_size) {
+    tiles.clear();
+    bounds = cv::Rect();
+    tile_size = std::max(tile_size, 1);
+    for (int y = 0; y < include_mask.rows; y += tile_size) {
+        for (int x = 0; x < include_mask.cols; x += tile_size) {
+            cv::Rect tile(x, y, std::min(tile_size, include_mask.cols - x), std::min(tile_size, include_mask.rows - y));
+            if (cv::countNonZero(include_mask(tile)) > 0) {
+                tiles.push_back(tile);
+                bounds = bounds.empty() ? tile : (bounds | tile);
+            }
+        }
+    }
+}
+
 ShadowLedentifier::ShadowLedentifier(int v_thresh, int s_thresh, int morph_size, int min_area)
     : value_threshold(v_thresh), saturation_threshold(s_thresh), morph_kernel_size(morph_size), min_shadow_area(min_area) {}
 
@@ -14,6 +83,8 @@ cv::Mat ShadowLedentifier::processImage(const cv::Mat& input, const std::string&
         std::cerr << "ERROR: Empty input image!" << std::endl;
         return cv::Mat();
     }
+    last_timings = Timings();
+    auto process_start = std::chrono::steady_clock::now();
     cv::Mat hsv;
     cv::cvtColor(input, hsv, cv::COLOR_BGR2HSV);
     std::vector<cv::Mat> hsv_channels;
@@ -28,35 +99,143 @@ cv::Mat ShadowLedentifier::processImage(const cv::Mat& input, const std::string&
     // 3. Морфология (open)
     cv::morphologyEx(v_mask_close, v_mask_open, cv::MORPH_OPEN, kernel, cv::Point(-1,-1), 1);
     // 4. Фильтрация по площади
+    cv::Mat filtered = filterByArea(v_mask_open);
+    last_timings.process_ms = elapsedMs(process_start);
+    // Debug output
+    if (!outputPath.empty()) {
+        auto encode_start = std::chrono::steady_clock::now();
+        prepareOutputDir(outputPath);
+        safeWrite(outputPath + "/1_input.jpg", input);
+        safeWrite(outputPath + "/2_v_mask.jpg", v_mask);
+        safeWrite(outputPath + "/3_v_mask_close.jpg", v_mask_close);
+        safeWrite(outputPath + "/4_v_mask_open.jpg", v_mask_open);
+        safeWrite(outputPath + "/5_filtered.jpg", filtered);
+        cv::Mat colored_result = createColoredMask(filtered, input);
+        safeWrite(outputPath + "/6_final_overlay.jpg", colored_result);
+        last_timings.encode_ms = elapsedMs(encode_start);
+    }
+    return filtered;
+}
+
+cv::Mat ShadowLedentifier::processImageTiled(const cv::Mat& input, const std::string& outputPath, int tile_size) {
+    if (input.empty()) {
+        std::cerr << "ERROR: Empty input image!" << std::endl;
+        return cv::Mat();
+    }
+    last_timings = Timings();
+    auto process_start = std::chrono::steady_clock::now();
+    // 1-3. Порог и морфология по тайлам, в полноразмерную маску пишется только ядро тайла
+    std::vector<cv::Rect> tiles;
+    tile_size = std::max(tile_size, 1);
+    for (int y = 0; y < input.rows; y += tile_size) {
+        for (int x = 0; x < input.cols; x += tile_size) {
+            tiles.emplace_back(x, y, std::min(tile_size, input.cols - x), std::min(tile_size, input.rows - y));
+        }
+    }
+    cv::Mat v_mask_open(input.size(), CV_8UC1);
+    segmentTiles(input, tiles, v_mask_open);
+    // 4. Фильтрация по площади
+    cv::Mat filtered = filterByArea(v_mask_open);
+    v_mask_open.release();
+    last_timings.process_ms = elapsedMs(process_start);
+    if (!outputPath.empty()) {
+        auto encode_start = std::chrono::steady_clock::now();
+        prepareOutputDir(outputPath);
+        safeWrite(outputPath + "/5_filtered.jpg", filtered);
+        last_timings.encode_ms = elapsedMs(encode_start);
+    }
+    return filtered;
+}
+
+cv::Mat ShadowLedentifier::processImage(const cv::Mat& input, const ProcessingRegion& region, const std::string& outputPath) {
+    if (input.empty()) {
+        std::cerr << "ERROR: Empty input image!" << std::endl;
+        return cv::Mat();
+    }
+    if (region.empty() || region.getFrameSize() != input.size()) {
+        std::cerr << "ERROR: Processing region does not match the frame size!" << std::endl;
+        return cv::Mat();
+    }
+    last_timings = Timings();
+    auto process_start = std::chrono::steady_clock::now();
+    const cv::Rect& bounds = region.getBounds();
+    cv::Mat roi_filtered;
+    if (!bounds.empty()) {
+        // 1-3. Порог и морфология только по тайлам области в маску размера bounds;
+        // перекрытие берется из соседних пикселей кадра, поэтому на границах ROI результат точный
+        cv::Mat v_mask_open(bounds.size(), CV_8UC1);
+        segmentTiles(input, region.getTiles(), v_mask_open, bounds.tl());
+        cv::bitwise_and(v_mask_open, region.getIncludeMask()(bounds), v_mask_open);
+        // 4. Фильтрация по площади в пределах области
+        roi_filtered = filterByArea(v_mask_open);
+    }
+    // Полноразмерная маска нужна только для результата
+    cv::Mat filtered = cv::Mat::zeros(input.size(), CV_8UC1);
+    if (!roi_filtered.empty()) {
+        roi_filtered.copyTo(filtered(bounds));
+    }
+    last_timings.process_ms = elapsedMs(process_start);
+    if (!outputPath.empty()) {
+        auto encode_start = std::chrono::steady_clock::now();
+        prepareOutputDir(outputPath);
+        safeWrite(outputPath + "/5_filtered.jpg", filtered);
+        safeWrite(outputPath + "/6_final_overlay.jpg", createColoredMask(filtered, input));
+        last_timings.encode_ms = elapsedMs(encode_start);
+    }
+    return filtered;
+}
+
+size_t ShadowLedentifier::estimateWorkingSet(int width, int height, bool tiled, int tile_size) const {
+    // Число каналов файла не учитывается: imread декодирует любой формат сразу в 8UC3
+    const size_t pixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+    if (!tiled) {
+        // 3 канала: вход, HSV, цветная маска и наложение в debug-выводе;
+        // 1 канал: 3 плоскости HSV, 4 маски этапов, копия внутри findContours
+        return pixels * (3 * 4 + 1 * 8);
+    }
+    // Вход (3 канала), маска после морфологии, копия в findContours и результат
+    // плюс буферы одного тайла с перекрытием: HSV (3 канала), V, маска и временная маска морфологии
+    const size_t side = static_cast<size_t>(tile_size + 2 * morphologyHalo());
+    return pixels * (3 + 3) + side * side * (3 + 3);
+}
+
+int ShadowLedentifier::morphologyHalo() const {
+    // close (2 итерации dilate + 2 erode) и open (erode + dilate): 6 проходов ядра
+    return (morph_kernel_size / 2) * 6;
+}
+
+cv::Mat ShadowLedentifier::segmentRegion(const cv::Mat& input, const cv::Rect& core) const {
+    const int halo = morphologyHalo();
+    cv::Rect outer(core.x - halo, core.y - halo, core.width + 2 * halo, core.height + 2 * halo);
+    outer &= cv::Rect(0, 0, input.cols, input.rows);
+
+    cv::Mat hsv, v_channel, v_mask, v_mask_close, v_mask_open;
+    cv::cvtColor(input(outer), hsv, cv::COLOR_BGR2HSV);
+    cv::extractChannel(hsv, v_channel, 2);
+    cv::threshold(v_channel, v_mask, value_threshold, 255, cv::THRESH_BINARY_INV);
+    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(morph_kernel_size, morph_kernel_size));
+    cv::morphologyEx(v_mask, v_mask_close, cv::MORPH_CLOSE, kernel, cv::Point(-1,-1), 2);
+    cv::morphologyEx(v_mask_close, v_mask_open, cv::MORPH_OPEN, kernel, cv::Point(-1,-1), 1);
+    return v_mask_open(cv::Rect(core.tl() - outer.tl(), core.size()));
+}
+
+void ShadowLedentifier::segmentTiles(const cv::Mat& input, const std::vector<cv::Rect>& tiles, cv::Mat& mask,
+                                     cv::Point origin) const {
+    for (const auto& tile : tiles) {
+        segmentRegion(input, tile).copyTo(mask(tile - origin));
+    }
+}
+
+cv::Mat ShadowLedentifier::filterByArea(const cv::Mat& mask) const {
     std::vector<std::vector<cv::Point>> contours;
-    cv::findContours(v_mask_open, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-    cv::Mat filtered = cv::Mat::zeros(v_mask_open.size(), CV_8UC1);
+    cv::findContours(mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    cv::Mat filtered = cv::Mat::zeros(mask.size(), CV_8UC1);
     for (const auto& contour : contours) {
         double area = cv::contourArea(contour);
         if (area > min_shadow_area) {
             cv::drawContours(filtered, std::vector<std::vector<cv::Point>>{contour}, -1, cv::Scalar(255), cv::FILLED);
         }
     }
-    // Debug output
-    if (!outputPath.empty()) {
-        std::error_code ec;
-        std::filesystem::create_directories(outputPath, ec);
-        if (ec) {
-            std::cerr << "[ERROR] Failed to create directory: " << outputPath << "\n";
-        }
-        auto safe_write = [](const std::string& path, const cv::Mat& img) {
-            if (!cv::imwrite(path, img)) {
-                std::cerr << "[ERROR] Failed to write: " << path << std::endl;
-            }
-        };
-        safe_write(outputPath + "/1_input.jpg", input);
-        safe_write(outputPath + "/2_v_mask.jpg", v_mask);
-        safe_write(outputPath + "/3_v_mask_close.jpg", v_mask_close);
-        safe_write(outputPath + "/4_v_mask_open.jpg", v_mask_open);
-        safe_write(outputPath + "/5_filtered.jpg", filtered);
-        cv::Mat colored_result = createColoredMask(filtered, input);
-        safe_write(outputPath + "/6_final_overlay.jpg", colored_result);
-    }
     return filtered;
 }
 
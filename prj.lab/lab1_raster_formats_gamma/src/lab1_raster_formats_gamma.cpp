@@ -26,22 +26,15 @@ cv::Mat applyGammaCorrection(const cv::Mat& image, double gamma) {
 }
 
 cv::Mat createGammaLUT(double gamma) {
-    cv::Mat lookupTable(1, 256, CV_8U);
-    uchar* p = lookupTable.ptr();
-
-    for (int i = 0; i < 256; ++i) {
-        p[i] = cv::saturate_cast<uchar>(pow(i / 255.0, 1.0 / gamma) * 255.0);
-    }
-
-    return lookupTable;
+    // The cached table is shared, callers get their own copy
+    return semcv::getGammaLUT(gamma, CV_8U).clone();
 }
 
 std::vector<cv::Mat> compareGammaValues(const cv::Mat& image, const std::vector<double>& gammaValues) {
-    std::vector<cv::Mat> results;
+    // All gammas are evaluated in one pass over the image
+    std::vector<cv::Mat> results = semcv::gammaCorrectionMulti(image, gammaValues);
 
     for (double gamma : gammaValues) {
-        cv::Mat corrected = applyGammaCorrection(image, gamma);
-        results.push_back(corrected);
         std::cout << "Applied gamma correction with gamma = " << gamma << std::endl;
     }
 
@@ -55,22 +48,21 @@ void analyzeHistogram(const cv::Mat& original, const cv::Mat& corrected) {
         cv::cvtColor(original, grayOriginal, cv::COLOR_BGR2GRAY);
         cv::cvtColor(corrected, grayCorrected, cv::COLOR_BGR2GRAY);
     } else {
-        grayOriginal = original.clone();
-        grayCorrected = corrected.clone();
+        grayOriginal = original;
+        grayCorrected = corrected;
     }
 
     // Calculate histograms
-    std::vector<cv::Mat> bgr_planes_orig, bgr_planes_corr;
-    cv::split(grayOriginal, bgr_planes_orig);
-    cv::split(grayCorrected, bgr_planes_corr);
-
     int histSize = 256;
-    float range[] = {0, 256};
-    const float* histRange = {range};
-
-    cv::Mat hist_orig, hist_corr;
-    cv::calcHist(&grayOriginal, 1, 0, cv::Mat(), hist_orig, 1, &histSize, &histRange);
-    cv::calcHist(&grayCorrected, 1, 0, cv::Mat(), hist_corr, 1, &histSize, &histRange);
+    auto toMat = [](const std::vector<uint64_t>& counts) {
+        cv::Mat hist(static_cast<int>(counts.size()), 1, CV_32F);
+        for (size_t i = 0; i < counts.size(); ++i) {
+            hist.at<float>(static_cast<int>(i)) = static_cast<float>(counts[i]);
+        }
+        return hist;
+    };
+    cv::Mat hist_orig = toMat(semcv::computeHistogram(grayOriginal));
+    cv::Mat hist_corr = toMat(semcv::computeHistogram(grayCorrected));
 
     // Create histogram images
     int hist_w = 512, hist_h = 400;
@@ -34,11 +34,12 @@ namespace lab2 {
     cv::Mat addUniformNoise(const cv::Mat& image, double amplitude = 50.0);
 
     /**
-     * @brief Add Poisson noise to an image
+     * @brief Add Poisson (photon shot) noise to an image
      * @param image Input image
+     * @param scale Photons per intensity level (larger values give less noise)
      * @return Noisy image
      */
-    cv::Mat addPoissonNoise(const cv::Mat& image);
+    cv::Mat addPoissonNoise(const cv::Mat& image, double scale = 1.0);
 
     /**
      * @brief Add speckle noise to an image
@@ -48,18 +49,38 @@ namespace lab2 {
      */
     cv::Mat addSpeckleNoise(const cv::Mat& image, double variance = 0.1);
 
+    /**
+     * @brief Result of one denoising method
+     */
+    struct DenoisingResult {
+        std::string method;
+        cv::Mat image;
+        double wallMs = 0.0;    ///< Wall time of the method, ms
+        double psnr = 0.0;      ///< PSNR against the reference, dB
+        double ssim = 0.0;      ///< Mean SSIM against the reference over channels
+    };
+
     /**
      * @brief Compare different denoising methods
+     * @details Methods run concurrently; non-local means is split into row tiles
      * @param noisyImage Noisy input image
      * @return Vector of denoised images using different methods
      */
     std::vector<cv::Mat> compareDenoisingMethods(const cv::Mat& noisyImage);
 
+    /**
+     * @brief Compare denoising methods with timing and quality against a reference
+     * @param noisyImage Noisy input image
+     * @param reference Clean reference image
+     * @return One result per method, in the order of compareDenoisingMethods
+     */
+    std::vector<DenoisingResult> evaluateDenoisingMethods(const cv::Mat& noisyImage, const cv::Mat& reference);
+
     /**
      * @brief Calculate Peak Signal-to-Noise Ratio (PSNR)
      * @param original Original clean image
      * @param noisy Noisy image
-     * @return PSNR value in dB
+     * @return PSNR value in dB, computed from the MSE over all channels
      */
     double calculatePSNR(const cv::Mat& original, const cv::Mat& noisy);
 
@@ -67,7 +88,7 @@ namespace lab2 {
      * @brief Calculate Mean Squared Error (MSE)
      * @param original Original clean image
      * @param noisy Noisy image
-     * @return MSE value
+     * @return MSE value over all channels
      */
     double calculateMSE(const cv::Mat& original, const cv::Mat& noisy);
 
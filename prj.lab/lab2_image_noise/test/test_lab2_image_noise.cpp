@@ -18,10 +18,11 @@ bool testGaussianNoise() {
     // Check that noise was actually added (images should be different)
     bool noiseAdded = (cv::norm(testImage, noisyImage) > 0);
 
-    // Calculate noise statistics
+    // Calculate signed noise statistics
     cv::Mat noise;
-    cv::absdiff(testImage, noisyImage, noise);
-    cv::Scalar noiseMean = cv::mean(noise);
+    noisyImage.convertTo(noise, CV_32F);
+    noise -= cv::Scalar(128);
+    cv::Scalar noiseMean;
     cv::Scalar noiseStddev;
     cv::meanStdDev(noise, noiseMean, noiseStddev);
 
@@ -109,6 +110,34 @@ bool testUniformNoise() {
     }
 }
 
+bool testPoissonNoise() {
+    std::cout << "Testing Poisson noise..." << std::endl;
+
+    cv::Mat testImage = cv::Mat::ones(100, 100, CV_8UC1) * 64;
+
+    cv::Mat noisyImage = lab2::addPoissonNoise(testImage);
+    cv::Mat lessNoisy = lab2::addPoissonNoise(testImage, 16.0);
+
+    cv::Scalar mean, stddev, lessMean, lessStddev;
+    cv::meanStdDev(noisyImage, mean, stddev);
+    cv::meanStdDev(lessNoisy, lessMean, lessStddev);
+
+    std::cout << "Noise mean: " << mean[0] << " (expected ~64)" << std::endl;
+    std::cout << "Noise stddev: " << stddev[0] << " (expected ~8), with scale 16: "
+              << lessStddev[0] << " (expected ~2)" << std::endl;
+
+    bool meanOk = std::abs(mean[0] - 64) < 1.0 && std::abs(lessMean[0] - 64) < 1.0;
+    bool stddevOk = std::abs(stddev[0] - 8) < 1.0 && std::abs(lessStddev[0] - 2) < 0.5;
+
+    if (meanOk && stddevOk) {
+        std::cout << "Poisson noise test PASSED" << std::endl;
+        return true;
+    } else {
+        std::cout << "Poisson noise test FAILED" << std::endl;
+        return false;
+    }
+}
+
 bool testPSNRCalculation() {
     std::cout << "Testing PSNR calculation..." << std::endl;
 
@@ -181,6 +210,36 @@ bool testDenoisingMethods() {
     }
 }
 
+bool testDenoisingEvaluation() {
+    std::cout << "Testing denoising evaluation..." << std::endl;
+
+    cv::Mat original = cv::Mat::zeros(160, 120, CV_8UC3);
+    cv::circle(original, cv::Point(60, 80), 40, cv::Scalar(200, 150, 100), -1);
+    cv::Mat noisy = lab2::addGaussianNoise(original, 0, 20);
+
+    std::vector<lab2::DenoisingResult> results = lab2::evaluateDenoisingMethods(noisy, original);
+
+    // Tiled non-local means matches a full-image run
+    cv::Mat expectedNLM;
+    cv::fastNlMeansDenoisingColored(noisy, expectedNLM, 3, 3, 7, 21);
+    bool nlmMatches = results.size() == 5 && cv::norm(results[4].image, expectedNLM, cv::NORM_INF) == 0;
+
+    bool metricsOk = true;
+    for (const auto& result : results) {
+        std::cout << result.method << ": " << result.psnr << " dB, SSIM " << result.ssim
+                  << ", " << result.wallMs << " ms" << std::endl;
+        metricsOk &= result.wallMs >= 0 && result.psnr > 0 && result.ssim > 0 && result.ssim <= 1.0;
+    }
+
+    if (nlmMatches && metricsOk) {
+        std::cout << "Denoising evaluation test PASSED" << std::endl;
+        return true;
+    } else {
+        std::cout << "Denoising evaluation test FAILED" << std::endl;
+        return false;
+    }
+}
+
 int main() {
     std::cout << "Running Lab 2 Tests" << std::endl;
     std::cout << "===================" << std::endl;
@@ -190,8 +249,10 @@ int main() {
     allPassed &= testGaussianNoise();
     allPassed &= testSaltPepperNoise();
     allPassed &= testUniformNoise();
+    allPassed &= testPoissonNoise();
     allPassed &= testPSNRCalculation();
     allPassed &= testDenoisingMethods();
+    allPassed &= testDenoisingEvaluation();
 
     std::cout << std::endl;
     if (allPassed) {
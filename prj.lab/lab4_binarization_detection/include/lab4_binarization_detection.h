@@ -44,7 +44,8 @@ namespace lab4 {
     /**
      * @brief Compare different binarization methods
      * @param image Input image
-     * @return Vector of binarized images using different methods
+     * @return Binarized images: global, Otsu, adaptive Gaussian, Niblack, Sauvola, Bradley.
+     *         The local-statistics methods share one integral image
      */
     std::vector<cv::Mat> compareBinarizationMethods(const cv::Mat& image);
 
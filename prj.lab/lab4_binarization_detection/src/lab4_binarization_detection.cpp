@@ -4,7 +4,32 @@
 
 namespace lab4 {
 
-// Implementation of functions will be here
+cv::Mat globalThresholding(const cv::Mat& image, double threshold) {
+    return semcv::globalThreshold(image, threshold);
+}
+
+cv::Mat otsuThresholding(const cv::Mat& image) {
+    return semcv::otsuThreshold(image);
+}
+
+cv::Mat adaptiveThresholding(const cv::Mat& image, int method, int blockSize, double C) {
+    return semcv::adaptiveThreshold(image, 255, method, cv::THRESH_BINARY, blockSize, C);
+}
+
+std::vector<cv::Mat> compareBinarizationMethods(const cv::Mat& image) {
+    cv::Mat gray = semcv::convertToGrayscale(image);
+
+    // Local-statistics methods share one integral image
+    semcv::IntegralImage integral(gray);
+    std::vector<cv::Mat> results;
+    results.push_back(globalThresholding(gray));
+    results.push_back(otsuThresholding(gray));
+    results.push_back(adaptiveThresholding(gray));
+    results.push_back(semcv::niblackThreshold(gray, integral));
+    results.push_back(semcv::sauvolaThreshold(gray, integral));
+    results.push_back(semcv::bradleyThreshold(gray, integral));
+    return results;
+}
 
 void runLab4Demo() {
     std::cout << "=== Lab 4: Object Detection using Binarization ===" << std::endl;
@@ -18,6 +43,13 @@ void runLab4Demo() {
 
     cv::imshow("Original Test Image", testImage);
 
+    const std::vector<std::string> methodNames = {"Global", "Otsu", "Adaptive Gaussian", "Niblack", "Sauvola", "Bradley"};
+    std::vector<cv::Mat> binarized = compareBinarizationMethods(testImage);
+    for (size_t i = 0; i < binarized.size(); ++i) {
+        std::cout << methodNames[i] << ": " << cv::countNonZero(binarized[i]) << " foreground pixels" << std::endl;
+        cv::imshow(methodNames[i], binarized[i]);
+    }
+
     std::cout << "Lab 4 demonstration completed." << std::endl;
     cv::waitKey(0);
     cv::destroyAllWindows();
@@ -13,12 +13,37 @@ bool testBasicFunctionality() {
     return true;
 }
 
+bool testCompareBinarizationMethods() {
+    std::cout << "Testing binarization comparison..." << std::endl;
+
+    cv::Mat testImage(120, 160, CV_8UC3, cv::Scalar(200, 200, 200));
+    cv::rectangle(testImage, cv::Point(30, 30), cv::Point(90, 90), cv::Scalar(40, 40, 40), -1);
+
+    std::vector<cv::Mat> results = lab4::compareBinarizationMethods(testImage);
+    bool valid = results.size() == 6;
+    for (const auto& result : results) {
+        cv::Mat nonBinary = (result != 0) & (result != 255);
+        valid &= result.size() == testImage.size() && result.type() == CV_8UC1 && cv::countNonZero(nonBinary) == 0;
+    }
+    // Global and Otsu split the dark square from the background
+    valid = valid && results[0].at<uchar>(60, 60) == 0 && results[0].at<uchar>(10, 10) == 255 &&
+             results[1].at<uchar>(60, 60) == 0 && results[1].at<uchar>(10, 10) == 255;
+
+    if (valid) {
+        std::cout << "Binarization comparison test PASSED" << std::endl;
+        return true;
+    }
+    std::cout << "Binarization comparison test FAILED" << std::endl;
+    return false;
+}
+
 int main() {
     std::cout << "Running Lab 4 Tests" << std::endl;
     std::cout << "==================================================" << std::endl;
 
     bool allPassed = true;
     allPassed &= testBasicFunctionality();
+    allPassed &= testCompareBinarizationMethods();
 
     if (allPassed) {
         std::cout << "All Lab 4 tests PASSED!" << std::endl;
@@ -5,35 +5,247 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/highgui.hpp>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
 namespace semcv {
 
     // Gamma correction functions
+    // Supports CV_8U and CV_16U (cached LUT) and CV_32F (fastPow) images
     cv::Mat gammaCorrection(const cv::Mat& image, double gamma);
     cv::Mat gammaCorrection(const cv::Mat& image, double gamma, cv::Mat& lookupTable);
+    // Thread-safe cached LUT keyed by (gamma, depth): 256 entries for CV_8U, 65536 for CV_16U.
+    // The returned table is shared between callers and must not be modified
+    cv::Mat getGammaLUT(double gamma, int depth = CV_8U);
+    // One output per gamma from a single sweep over the input (row blocks in parallel)
+    std::vector<cv::Mat> gammaCorrectionMulti(const cv::Mat& image, const std::vector<double>& gammas);
+    // x^p for x >= 0 via log2/exp2 approximations; 0 for x <= 0.
+    // Relative error below 1e-5 while x^p stays in the normal float range
+    float fastPow(float x, float p);
 
     // Noise generation functions
+    // Gaussian, uniform and speckle noise are generated and added in one parallel pass from a
+    // counter-based RNG: the same seed gives the same image for any thread count. Signed noise
+    // is added with saturation. Overloads without a seed take one from cv::theRNG()
     cv::Mat addGaussianNoise(const cv::Mat& image, double mean = 0.0, double stddev = 25.0);
+    cv::Mat addGaussianNoise(const cv::Mat& image, double mean, double stddev, uint64_t seed);
+    // Each pixel becomes salt (255) with saltProb and pepper (0) with pepperProb; only the
+    // corrupted pixels are visited (geometric gaps), the in-place version costs O(corrupted)
     cv::Mat addSaltPepperNoise(const cv::Mat& image, double saltProb = 0.05, double pepperProb = 0.05);
+    cv::Mat addSaltPepperNoise(const cv::Mat& image, double saltProb, double pepperProb, uint64_t seed);
+    void applySaltPepperNoise(cv::Mat& image, double saltProb, double pepperProb, uint64_t seed);
     cv::Mat addUniformNoise(const cv::Mat& image, double amplitude = 50.0);
+    cv::Mat addUniformNoise(const cv::Mat& image, double amplitude, uint64_t seed);
+    // result = image + image * n, n ~ N(0, variance) on the intensity scale of the image
+    cv::Mat addSpeckleNoise(const cv::Mat& image, double variance = 0.1);
+    cv::Mat addSpeckleNoise(const cv::Mat& image, double variance, uint64_t seed);
+    // Photon-count noise: k ~ Poisson(value * scale), result = k / scale, so a larger scale means
+    // more photons per intensity level and less noise. 8-bit images sample precomputed
+    // inverse-CDF tables (cached per scale)
+    cv::Mat addPoissonNoise(const cv::Mat& image, double scale = 1.0);
+    cv::Mat addPoissonNoise(const cv::Mat& image, double scale, uint64_t seed);
 
     // Auto contrast functions
     cv::Mat autoContrast(const cv::Mat& image, double clipPercent = 1.0);
+    // Color images: luma is equalized in one read and one write pass, chroma is kept
     cv::Mat adaptiveHistogramEqualization(const cv::Mat& image);
+    // Keeps the chroma of color images (see ClaheEngine)
     cv::Mat claheContrast(const cv::Mat& image, double clipLimit = 2.0, cv::Size tileGridSize = cv::Size(8,8));
 
+    // Linear map used by autoContrast: result = image * alpha + beta
+    void autoContrastCoefficients(const cv::Mat& image, double clipPercent, double& alpha, double& beta);
+
+    // Point operation fusion
+    // Chain of 8-bit point operations composed into one 256-entry LUT and applied in a single
+    // pass. Results are bit-identical to calling the operations one after another; unlike
+    // globalThreshold, color images are thresholded per channel instead of converted to gray
+    class PointOps {
+    public:
+        PointOps();
+        PointOps& gamma(double gamma);
+        PointOps& linear(double alpha, double beta);
+        // Linear map autoContrast would compute for reference
+        PointOps& autoContrast(const cv::Mat& reference, double clipPercent = 1.0);
+        PointOps& threshold(double threshold, int maxval = 255, int type = cv::THRESH_BINARY);
+        PointOps& lut(const cv::Mat& table);
+
+        const cv::Mat& table() const { return lookupTable; }
+        cv::Mat apply(const cv::Mat& image) const;
+
+    private:
+        cv::Mat lookupTable;
+    };
+
+    // Auto contrast for frame sequences: the histogram is taken from a rotating subsample
+    // grid, clip points are smoothed over time (no flicker) and applied as one LUT pass.
+    // smoothing is the weight of the newest frame, 1 disables temporal smoothing
+    class TemporalAutoContrast {
+    public:
+        explicit TemporalAutoContrast(double clipPercent = 1.0, double smoothing = 0.2, int subsample = 4);
+        cv::Mat apply(const cv::Mat& frame);
+        void reset();
+
+        double getLow() const { return low; }
+        double getHigh() const { return high; }
+
+    private:
+        double clipPercent;
+        double smoothing;
+        int subsample;
+        int64_t frameIndex = 0;
+        cv::Size frameSize;
+        double low = 0.0;
+        double high = 255.0;
+        cv::Mat samples;
+    };
+
+    // Persistent CLAHE: the cv::CLAHE object and conversion buffers live across calls.
+    // Color images are equalized on L of Lab or on Y of YCrCb (conversion fused into the
+    // read and write passes), chroma is kept
+    enum class ClaheColorSpace { Lab, YCrCb };
+
+    class ClaheEngine {
+    public:
+        explicit ClaheEngine(double clipLimit = 2.0, cv::Size tileGridSize = cv::Size(8,8),
+                             ClaheColorSpace colorSpace = ClaheColorSpace::YCrCb);
+        void setClipLimit(double clipLimit);
+        void setTilesGridSize(cv::Size tileGridSize);
+        cv::Mat apply(const cv::Mat& image);
+
+    private:
+        cv::Ptr<cv::CLAHE> clahe;
+        ClaheColorSpace colorSpace;
+        cv::Mat colorBuffer;
+        cv::Mat luma;
+        cv::Mat equalized;
+    };
+
+    // Histogram functions
+    // CV_8U (256 bins) and CV_16U (65536 bins); per-thread banked partials with a parallel reduce.
+    // computeHistogram counts every sample, computeChannelHistograms one histogram per channel
+    std::vector<uint64_t> computeHistogram(const cv::Mat& image);
+    std::vector<std::vector<uint64_t>> computeChannelHistograms(const cv::Mat& image);
+    std::vector<uint64_t> cumulativeHistogram(const std::vector<uint64_t>& histogram);
+    // Smallest bin whose cumulative count reaches percent of the total
+    int histogramPercentile(const std::vector<uint64_t>& cumulative, double percent);
+    // Threshold maximizing between-class variance, identical to cv::THRESH_OTSU
+    int otsuThresholdValue(const std::vector<uint64_t>& histogram);
+    // classes - 1 thresholds maximizing the between-class variance, found by dynamic programming
+    // over prefix sums in O(classes * bins^2). Class c holds values in (t[c-1], t[c]]
+    std::vector<int> multiOtsuThresholds(const std::vector<uint64_t>& histogram, int classes);
+
+    // Quality metrics functions
+    // Everything below comes from one pass over both images; noise is candidate - reference.
+    // Per-channel values are in cv::Scalar slots [0, channels)
+    struct QualityStats {
+        int channels = 0;
+        cv::Scalar sse;
+        cv::Scalar mse;
+        cv::Scalar psnr;            // dB, infinity for identical channels
+        cv::Scalar signalMean;      // reference
+        cv::Scalar signalStddev;
+        cv::Scalar noiseMean;
+        cv::Scalar noiseStddev;
+        cv::Scalar absNoiseMean;
+        cv::Scalar snr;             // 20 * log10(signalMean / noiseStddev), dB
+        double mseAll = 0.0;        // over all channels
+        double psnrAll = 0.0;
+        double maxError = 0.0;
+    };
+    QualityStats computeQuality(const cv::Mat& reference, const cv::Mat& candidate, double maxValue = 255.0);
+    // One read of the reference for all candidates
+    std::vector<QualityStats> computeQuality(const cv::Mat& reference, const std::vector<cv::Mat>& candidates, double maxValue = 255.0);
+    // Mean SSIM per channel over all window x window positions (box window, running sums)
+    cv::Scalar computeSSIM(const cv::Mat& reference, const cv::Mat& candidate, int window = 7, double maxValue = 255.0);
+
+    // Integral image functions
+    // 64-bit sums and squared sums of a single-channel CV_8U or CV_16U image, built in parallel
+    // stripes. Box statistics are O(1) per pixel; windows are clipped at the image borders
+    class IntegralImage {
+    public:
+        explicit IntegralImage(const cv::Mat& image);
+        int rows() const { return height; }
+        int cols() const { return width; }
+        int64_t sum(const cv::Rect& rect) const;
+        int64_t squareSum(const cv::Rect& rect) const;
+        // CV_32F mean (and population variance) of the window centred on every pixel
+        cv::Mat boxMean(cv::Size window) const;
+        void boxMeanVariance(cv::Size window, cv::Mat& mean, cv::Mat& variance) const;
+
+    private:
+        int height;
+        int width;
+        std::vector<int64_t> sums;
+        std::vector<int64_t> squareSums;
+    };
+    // Local thresholds from the window mean m and standard deviation s; pixels above the
+    // threshold become 255. Niblack: m + k*s, Sauvola: m*(1 + k*(s/R - 1)), Bradley: m*(1 - t).
+    // The overloads taking an IntegralImage of gray let several methods share one
+    cv::Mat niblackThreshold(const cv::Mat& gray, const IntegralImage& integral, int blockSize = 25, double k = -0.2);
+    cv::Mat sauvolaThreshold(const cv::Mat& gray, const IntegralImage& integral, int blockSize = 25, double k = 0.2, double R = 128);
+    cv::Mat bradleyThreshold(const cv::Mat& gray, const IntegralImage& integral, int blockSize = 25, double t = 0.15);
+    cv::Mat niblackThreshold(const cv::Mat& image, int blockSize = 25, double k = -0.2);
+    cv::Mat sauvolaThreshold(const cv::Mat& image, int blockSize = 25, double k = 0.2, double R = 128);
+    cv::Mat bradleyThreshold(const cv::Mat& image, int blockSize = 25, double t = 0.15);
+
     // Binarization functions
     cv::Mat globalThreshold(const cv::Mat& image, double threshold = 128, int maxval = 255, int type = cv::THRESH_BINARY);
     cv::Mat otsuThreshold(const cv::Mat& image);
+    // Label image (CV_8U, 0 .. classes - 1) from one histogram pass and one LUT pass
+    cv::Mat multiOtsuThreshold(const cv::Mat& image, int classes = 3, std::vector<int>* thresholds = nullptr);
     cv::Mat adaptiveThreshold(const cv::Mat& image, int maxval = 255, int adaptiveMethod = cv::ADAPTIVE_THRESH_GAUSSIAN_C, int type = cv::THRESH_BINARY, int blockSize = 11, double C = 2);
+    // Streaming binarization for images too large to hold: readRows fills a CV_8UC1 buffer with
+    // gray rows [first, first + rows.rows), writeRows receives finished rows in order. Both are
+    // called from the calling thread only; batches of strips are processed in parallel, so memory
+    // depends on stripHeight, not on the image height. Otsu reads the image twice (histogram,
+    // then apply), adaptive methods once with blockSize / 2 halo rows. Results match
+    // otsuThreshold and adaptiveThreshold on the whole image
+    enum class StreamingThreshold { Otsu, AdaptiveMean, AdaptiveGaussian };
+    using RowReader = std::function<void(int first, cv::Mat& rows)>;
+    using RowWriter = std::function<void(int first, const cv::Mat& rows)>;
+    void binarizeStreaming(cv::Size size, const RowReader& readRows, const RowWriter& writeRows,
+                           StreamingThreshold method = StreamingThreshold::Otsu, int blockSize = 11, double C = 2, int stripHeight = 256);
+    // In-memory CV_8UC1/CV_8UC3 input converted to gray strip by strip
+    cv::Mat binarizeTiled(const cv::Mat& image, StreamingThreshold method = StreamingThreshold::Otsu, int blockSize = 11, double C = 2, int stripHeight = 256);
 
     // Linear filtering functions
+    // Sigmas of 8 and above with a kernel covering +-3 sigma (or zero size) use recursiveGaussianFilter
+    // with the same BORDER_REFLECT_101 border as GaussianBlur, so the switch does not move the edges
     cv::Mat gaussianFilter(const cv::Mat& image, cv::Size kernelSize = cv::Size(5,5), double sigmaX = 1.0, double sigmaY = 0);
+    // Young-van Vliet recursive Gaussian, O(1) per pixel for any sigma >= 0.5. Rows in parallel,
+    // then column blocks. BORDER_REPLICATE is exact (Triggs-Sdika initialisation); BORDER_REFLECT_101
+    // runs over 4 sigma of reflected samples per side
+    cv::Mat recursiveGaussianFilter(const cv::Mat& image, double sigmaX, double sigmaY = 0, int borderType = cv::BORDER_REPLICATE);
+    struct GaussianTiming {
+        double sigma = 0.0;
+        double firMs = 0.0;
+        double iirMs = 0.0;
+    };
+    // GaussianBlur with a +-3 sigma kernel against recursiveGaussianFilter, mean of `repeats` runs
+    std::vector<GaussianTiming> benchmarkGaussianFilters(const cv::Mat& image, const std::vector<double>& sigmas = {1, 2, 4, 8, 16, 32, 64}, int repeats = 3);
     cv::Mat boxFilter(const cv::Mat& image, cv::Size kernelSize = cv::Size(5,5));
     cv::Mat medianFilter(const cv::Mat& image, int kernelSize = 5);
+    // Windows above 5x5: constant-time median (Perreault-Hebert) for CV_8U, sliding histogram
+    // for CV_16U, vertical strips in parallel. Rectangular windows, borders replicated
+    cv::Mat medianFilter(const cv::Mat& image, cv::Size kernelSize);
+    // Switching median for impulse noise: only extreme-valued pixels in small same-valued regions
+    // (under 16 pixels, 8-connected) are replaced, by the median of the clean pixels in a window growing up to
+    // maxKernelSize. Other pixels are returned unchanged
+    cv::Mat adaptiveMedianFilter(const cv::Mat& image, int maxKernelSize = 7);
+    // sigmaSpace of 8 and above with d covering the window OpenCV derives (or d <= 0) takes the bilateral grid path
     cv::Mat bilateralFilter(const cv::Mat& image, int d = 9, double sigmaColor = 75, double sigmaSpace = 75);
+    // Approximate bilateral filter on a space x intensity grid: splat, separable blur, trilinear
+    // slice. Cost barely depends on sigmaSpace; cells are samplingScale sigmas wide, so smaller
+    // values are more accurate and slower. Colour images use luma as the range guide
+    cv::Mat bilateralGridFilter(const cv::Mat& image, double sigmaColor = 75, double sigmaSpace = 75, double samplingScale = 1.0);
+    // Quality of the grid result measured against the exact cv::bilateralFilter
+    QualityStats bilateralGridError(const cv::Mat& image, double sigmaColor = 75, double sigmaSpace = 75, double samplingScale = 1.0);
+    // Kernels are analysed once (plan cached per kernel): low-rank kernels run as sums of
+    // separable passes, large full-rank kernels as tiled FFT convolution, the rest via filter2D
+    enum class LinearFilterMethod { Direct, Separable, Fft };
+    LinearFilterMethod linearFilterMethod(const cv::Mat& kernel);
     cv::Mat customLinearFilter(const cv::Mat& image, const cv::Mat& kernel);
 
     // Object detection functions
@@ -57,10 +269,29 @@ namespace semcv {
     // Test functions
     bool runTests();
     bool testGammaCorrection();
+    bool testGammaLUTCache();
+    bool testGammaCorrectionMulti();
     bool testNoiseGeneration();
+    bool testNoiseDeterminism();
+    bool testPoissonNoise();
+    bool testSaltPepperNoise();
     bool testAutoContrast();
+    bool testPointOps();
+    bool testTemporalAutoContrast();
+    bool testClaheEngine();
+    bool testColorEqualization();
+    bool testHistogram();
+    bool testQualityMetrics();
     bool testBinarization();
     bool testLinearFiltering();
+    bool testAdaptiveMedian();
+    bool testLargeMedian();
+    bool testBilateralGrid();
+    bool testRecursiveGaussian();
+    bool testCustomLinearFilter();
+    bool testIntegralImage();
+    bool testStreamingBinarization();
+    bool testMultiOtsu();
     bool testObjectDetection();
     bool testEdgeDetection();
 
@@ -1,86 +1,250 @@
 #include "semcv.h"
+#include <algorithm>
 
 namespace semcv {
 
-cv::Mat autoContrast(const cv::Mat& image, double clipPercent) {
+namespace {
+
+// Gray levels below which and above which clipPercent / 2 of the samples lie
+void clipPoints(const std::vector<uint64_t>& histogram, double clipPercent, int& minGray, int& maxGray) {
+    std::vector<uint64_t> cumulative = cumulativeHistogram(histogram);
+
+    uint64_t total = cumulative.back();
+    uint64_t clipCount = static_cast<uint64_t>(total * clipPercent / 100.0 / 2.0);
+
+    minGray = 0;
+    maxGray = 255;
+    while (cumulative[minGray] < clipCount && minGray < 255) minGray++;
+    while (cumulative[maxGray] >= (total - clipCount) && maxGray > 0) maxGray--;
+}
+
+// Same fixed-point weights as cv::COLOR_BGR2GRAY for 8-bit data
+inline int bgrLuma(const uchar* bgr) {
+    return (bgr[0] * 1868 + bgr[1] * 9617 + bgr[2] * 4899 + (1 << 13)) >> 14;
+}
+
+} // namespace
+
+void autoContrastCoefficients(const cv::Mat& image, double clipPercent, double& alpha, double& beta) {
     cv::Mat gray;
     if (image.channels() == 3) {
         cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
     } else {
-        gray = image.clone();
-    }
-
-    std::vector<int> histogram(256, 0);
-    for (int y = 0; y < gray.rows; y++) {
-        for (int x = 0; x < gray.cols; x++) {
-            histogram[gray.at<uchar>(y, x)]++;
-        }
-    }
-
-    std::vector<int> cumulative(256, 0);
-    cumulative[0] = histogram[0];
-    for (int i = 1; i < 256; i++) {
-        cumulative[i] = cumulative[i-1] + histogram[i];
+        gray = image;
     }
 
-    int total = gray.rows * gray.cols;
-    int clipCount = static_cast<int>(total * clipPercent / 100.0 / 2.0);
+    int minGray, maxGray;
+    clipPoints(computeHistogram(gray), clipPercent, minGray, maxGray);
 
-    int minGray = 0, maxGray = 255;
-    while (cumulative[minGray] < clipCount && minGray < 255) minGray++;
-    while (cumulative[maxGray] >= (total - clipCount) && maxGray > 0) maxGray--;
+    alpha = 255.0 / (maxGray - minGray);
+    beta = -minGray * alpha;
+}
 
-    double alpha = 255.0 / (maxGray - minGray);
-    double beta = -minGray * alpha;
+cv::Mat autoContrast(const cv::Mat& image, double clipPercent) {
+    double alpha, beta;
+    autoContrastCoefficients(image, clipPercent, alpha, beta);
 
     cv::Mat result;
     image.convertTo(result, -1, alpha, beta);
     return result;
 }
 
-cv::Mat adaptiveHistogramEqualization(const cv::Mat& image) {
-    cv::Mat gray;
-    if (image.channels() == 3) {
-        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+TemporalAutoContrast::TemporalAutoContrast(double clipPercent, double smoothing, int subsample)
+    : clipPercent(clipPercent), smoothing(std::min(std::max(smoothing, 0.0), 1.0)), subsample(std::max(subsample, 1)) {}
+
+void TemporalAutoContrast::reset() {
+    frameIndex = 0;
+    frameSize = cv::Size();
+}
+
+cv::Mat TemporalAutoContrast::apply(const cv::Mat& frame) {
+    if (frame.type() != CV_8UC1 && frame.type() != CV_8UC3) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "TemporalAutoContrast: only CV_8UC1 and CV_8UC3 frames are supported");
+    }
+    if (frame.size() != frameSize) {
+        reset();
+        frameSize = frame.size();
+    }
+
+    // Each frame samples a different phase of the subsample grid, so every pixel
+    // is visited once per subsample^2 frames
+    const int phase = static_cast<int>(frameIndex % (subsample * subsample));
+    const int offsetY = std::min(phase / subsample, frame.rows - 1);
+    const int offsetX = std::min(phase % subsample, frame.cols - 1);
+    // The grid samples (luma for colour) are gathered into a small reused buffer
+    samples.create((frame.rows - offsetY + subsample - 1) / subsample, (frame.cols - offsetX + subsample - 1) / subsample, CV_8UC1);
+    for (int i = 0; i < samples.rows; ++i) {
+        const uchar* row = frame.ptr(offsetY + i * subsample);
+        uchar* dst = samples.ptr(i);
+        if (frame.channels() == 1) {
+            for (int j = 0; j < samples.cols; ++j) {
+                dst[j] = row[offsetX + j * subsample];
+            }
+        } else {
+            for (int j = 0; j < samples.cols; ++j) {
+                dst[j] = static_cast<uchar>(bgrLuma(row + 3 * (offsetX + j * subsample)));
+            }
+        }
+    }
+    std::vector<uint64_t> histogram = computeHistogram(samples);
+
+    int minGray, maxGray;
+    clipPoints(histogram, clipPercent, minGray, maxGray);
+    if (frameIndex == 0) {
+        low = minGray;
+        high = maxGray;
     } else {
-        gray = image.clone();
+        low += smoothing * (minGray - low);
+        high += smoothing * (maxGray - high);
     }
+    ++frameIndex;
+
+    double alpha = 255.0 / std::max(high - low, 1.0);
+    return PointOps().linear(alpha, -low * alpha).apply(frame);
+}
 
+cv::Mat adaptiveHistogramEqualization(const cv::Mat& image) {
     cv::Mat result;
-    cv::equalizeHist(gray, result);
+    if (image.channels() == 1) {
+        cv::equalizeHist(image, result);
+        return result;
+    }
+    if (image.type() != CV_8UC3) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "adaptiveHistogramEqualization: color input must be CV_8UC3");
+    }
 
-    if (image.channels() == 3) {
-        cv::Mat channels[3];
-        cv::split(image, channels);
-        cv::merge(channels, 3, result);
-        cv::cvtColor(result, result, cv::COLOR_BGR2GRAY);
-        cv::equalizeHist(result, result);
-        cv::cvtColor(result, result, cv::COLOR_GRAY2BGR);
+    // Read pass: luma histogram straight from interleaved BGR, per-stripe partials
+    const int stripes = std::max(1, std::min(image.rows, cv::getNumThreads()));
+    std::vector<uint64_t> partials(static_cast<size_t>(stripes) * 256, 0);
+    cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s) {
+            uint64_t* histogram = partials.data() + s * 256;
+            for (int y = image.rows * s / stripes; y < image.rows * (s + 1) / stripes; ++y) {
+                const uchar* src = image.ptr(y);
+                for (int x = 0; x < image.cols; ++x) {
+                    histogram[bgrLuma(src + 3 * x)]++;
+                }
+            }
+        }
+    });
+    std::vector<uint64_t> histogram(256, 0);
+    for (int s = 0; s < stripes; ++s) {
+        for (int i = 0; i < 256; ++i) {
+            histogram[i] += partials[s * 256 + i];
+        }
+    }
+
+    // Same mapping as cv::equalizeHist, stored as the change of luma per level
+    int delta[256] = {0};
+    int first = 0;
+    while (first < 255 && histogram[first] == 0) first++;
+    const uint64_t total = image.total();
+    if (histogram[first] == total) {
+        for (int i = 0; i < 256; ++i) {
+            delta[i] = first - i;
+        }
+    } else {
+        const float scale = 255.0f / (total - histogram[first]);
+        uint64_t sum = 0;
+        for (int i = first; i < 256; ++i) {
+            if (i > first) {
+                sum += histogram[i];
+            }
+            delta[i] = cv::saturate_cast<uchar>(sum * scale) - i;
+        }
     }
 
+    // Write pass: luma is recomputed and every channel shifts by its change, so chroma is kept
+    result.create(image.size(), CV_8UC3);
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const uchar* src = image.ptr(y);
+            uchar* dst = result.ptr(y);
+            for (int x = 0; x < image.cols; ++x) {
+                int d = delta[bgrLuma(src + 3 * x)];
+                for (int c = 0; c < 3; ++c) {
+                    dst[3 * x + c] = cv::saturate_cast<uchar>(src[3 * x + c] + d);
+                }
+            }
+        }
+    });
     return result;
 }
 
-cv::Mat claheContrast(const cv::Mat& image, double clipLimit, cv::Size tileGridSize) {
-    cv::Mat gray;
-    if (image.channels() == 3) {
-        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
-    } else {
-        gray = image.clone();
+ClaheEngine::ClaheEngine(double clipLimit, cv::Size tileGridSize, ClaheColorSpace colorSpace)
+    : clahe(cv::createCLAHE(clipLimit, tileGridSize)), colorSpace(colorSpace) {}
+
+void ClaheEngine::setClipLimit(double clipLimit) {
+    if (clahe->getClipLimit() != clipLimit) {
+        clahe->setClipLimit(clipLimit);
     }
+}
 
-    cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE();
-    clahe->setClipLimit(clipLimit);
-    clahe->setTilesGridSize(tileGridSize);
+void ClaheEngine::setTilesGridSize(cv::Size tileGridSize) {
+    if (clahe->getTilesGridSize() != tileGridSize) {
+        clahe->setTilesGridSize(tileGridSize);
+    }
+}
 
+cv::Mat ClaheEngine::apply(const cv::Mat& image) {
+    // cv::CLAHE computes tile LUTs and interpolates in parallel and keeps its
+    // tile buffers between calls; the conversion buffers here are reused as well
     cv::Mat result;
-    clahe->apply(gray, result);
+    if (image.channels() == 1) {
+        clahe->apply(image, result);
+        return result;
+    }
+    if (image.type() != CV_8UC3) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "ClaheEngine: color input must be CV_8UC3");
+    }
 
-    if (image.channels() == 3) {
-        cv::cvtColor(result, result, cv::COLOR_GRAY2BGR);
+    if (colorSpace == ClaheColorSpace::Lab) {
+        cv::cvtColor(image, colorBuffer, cv::COLOR_BGR2Lab);
+        cv::extractChannel(colorBuffer, luma, 0);
+        clahe->apply(luma, equalized);
+        cv::insertChannel(equalized, colorBuffer, 0);
+        cv::cvtColor(colorBuffer, result, cv::COLOR_Lab2BGR);
+        return result;
     }
 
+    // YCrCb with the conversion fused into the passes: Y is computed while reading BGR,
+    // and keeping Cr/Cb means every channel shifts by the change in Y
+    luma.create(image.size(), CV_8UC1);
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const uchar* src = image.ptr(y);
+            uchar* dst = luma.ptr(y);
+            for (int x = 0; x < image.cols; ++x) {
+                dst[x] = static_cast<uchar>(bgrLuma(src + 3 * x));
+            }
+        }
+    });
+    clahe->apply(luma, equalized);
+
+    result.create(image.size(), CV_8UC3);
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const uchar* src = image.ptr(y);
+            const uchar* before = luma.ptr(y);
+            const uchar* after = equalized.ptr(y);
+            uchar* dst = result.ptr(y);
+            for (int x = 0; x < image.cols; ++x) {
+                int delta = after[x] - before[x];
+                for (int c = 0; c < 3; ++c) {
+                    dst[3 * x + c] = cv::saturate_cast<uchar>(src[3 * x + c] + delta);
+                }
+            }
+        }
+    });
     return result;
 }
 
+cv::Mat claheContrast(const cv::Mat& image, double clipLimit, cv::Size tileGridSize) {
+    // One engine per thread, so repeated calls skip the setup and allocations
+    thread_local ClaheEngine engine(clipLimit, tileGridSize);
+    engine.setClipLimit(clipLimit);
+    engine.setTilesGridSize(tileGridSize);
+    return engine.apply(image);
 }
+
+} // namespace semcv
@@ -0,0 +1,186 @@
+#include "semcv.h"
+#include <algorithm>
+#include <cmath>
+
+namespace semcv {
+
+namespace {
+
+// Downsampled space x intensity grid. Each cell holds a homogeneous weight followed by
+// one sum per channel, laid out [y][x][z][weight, sums...]
+struct BilateralGrid {
+    int width = 0, height = 0, depth = 0, stride = 0;
+    std::vector<float> data;
+
+    float* cell(int gy, int gx, int gz) {
+        return &data[((static_cast<size_t>(gy) * width + gx) * depth + gz) * stride];
+    }
+};
+
+// Gaussian along one grid axis for every line (a, b); lines start at a * strideA + b * strideB
+// and step `step` floats per cell. Zero padding of the grid makes the borders exact
+void blurLines(BilateralGrid& grid, int countA, int countB, size_t strideA, size_t strideB,
+               size_t step, int length, const std::vector<float>& kernel) {
+    const int radius = static_cast<int>(kernel.size()) / 2;
+    const int S = grid.stride;
+    cv::parallel_for_(cv::Range(0, countA), [&](const cv::Range& range) {
+        std::vector<float> line(static_cast<size_t>(length) * S);
+        for (int a = range.start; a < range.end; ++a) {
+            for (int b = 0; b < countB; ++b) {
+                float* base = grid.data.data() + a * strideA + b * strideB;
+                for (int i = 0; i < length; ++i) {
+                    std::copy(base + i * step, base + i * step + S, &line[static_cast<size_t>(i) * S]);
+                }
+                for (int i = 0; i < length; ++i) {
+                    float* out = base + i * step;
+                    std::fill(out, out + S, 0.0f);
+                    for (int k = std::max(-radius, -i); k <= std::min(radius, length - 1 - i); ++k) {
+                        const float w = kernel[k + radius];
+                        const float* in = &line[static_cast<size_t>(i + k) * S];
+                        for (int c = 0; c < S; ++c) {
+                            out[c] += w * in[c];
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+
+template <typename T>
+void splat(const cv::Mat& image, const cv::Mat& guide, BilateralGrid& grid, double cellSpace,
+           double cellRange, double minGuide, int pad, int coreHeight) {
+    // Image rows [bounds[k], bounds[k + 1]) fall into grid row k, so grid rows splat in parallel
+    std::vector<int> bounds(coreHeight + 1, 0);
+    for (int y = 0; y < image.rows; ++y) {
+        bounds[cvRound(y / cellSpace) + 1]++;
+    }
+    for (int k = 0; k < coreHeight; ++k) {
+        bounds[k + 1] += bounds[k];
+    }
+    const int cn = image.channels();
+    cv::parallel_for_(cv::Range(0, coreHeight), [&](const cv::Range& range) {
+        for (int k = range.start; k < range.end; ++k) {
+            for (int y = bounds[k]; y < bounds[k + 1]; ++y) {
+                const T* src = image.ptr<T>(y);
+                const float* g = guide.ptr<float>(y);
+                for (int x = 0; x < image.cols; ++x) {
+                    float* c = grid.cell(k + pad, cvRound(x / cellSpace) + pad, cvRound((g[x] - minGuide) / cellRange) + pad);
+                    c[0] += 1.0f;
+                    for (int ch = 0; ch < cn; ++ch) {
+                        c[ch + 1] += static_cast<float>(src[x * cn + ch]);
+                    }
+                }
+            }
+        }
+    });
+}
+
+// Trilinear interpolation of the blurred grid at every pixel, normalised by the weight
+template <typename T>
+void slice(const cv::Mat& image, const cv::Mat& guide, BilateralGrid& grid, double cellSpace,
+           double cellRange, double minGuide, int pad, cv::Mat& result) {
+    const int cn = image.channels();
+    const size_t dz = grid.stride, dx = static_cast<size_t>(grid.depth) * dz, dy = grid.width * dx;
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        float acc[4];
+        for (int y = range.start; y < range.end; ++y) {
+            const T* src = image.ptr<T>(y);
+            const float* g = guide.ptr<float>(y);
+            T* dst = result.ptr<T>(y);
+            const double fy = y / cellSpace + pad;
+            const int iy = static_cast<int>(fy);
+            const float wy = static_cast<float>(fy - iy);
+            for (int x = 0; x < image.cols; ++x) {
+                const double fx = x / cellSpace + pad, fz = (g[x] - minGuide) / cellRange + pad;
+                const int ix = static_cast<int>(fx), iz = static_cast<int>(fz);
+                const float wx = static_cast<float>(fx - ix), wz = static_cast<float>(fz - iz);
+                const float* c = grid.cell(iy, ix, iz);
+                std::fill(acc, acc + grid.stride, 0.0f);
+                for (int corner = 0; corner < 8; ++corner) {
+                    const int by = corner >> 2, bx = (corner >> 1) & 1, bz = corner & 1;
+                    const float w = (by ? wy : 1 - wy) * (bx ? wx : 1 - wx) * (bz ? wz : 1 - wz);
+                    const float* v = c + by * dy + bx * dx + bz * dz;
+                    for (int s = 0; s < grid.stride; ++s) {
+                        acc[s] += w * v[s];
+                    }
+                }
+                for (int ch = 0; ch < cn; ++ch) {
+                    dst[x * cn + ch] = acc[0] > 0 ? cv::saturate_cast<T>(acc[ch + 1] / acc[0]) : src[x * cn + ch];
+                }
+            }
+        }
+    });
+}
+
+} // namespace
+
+cv::Mat bilateralGridFilter(const cv::Mat& image, double sigmaColor, double sigmaSpace, double samplingScale) {
+    if ((image.depth() != CV_8U && image.depth() != CV_32F) || (image.channels() != 1 && image.channels() != 3)) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "bilateralGridFilter: only 1- and 3-channel CV_8U or CV_32F images are supported");
+    }
+    if (sigmaColor <= 0 || sigmaSpace <= 0 || samplingScale <= 0) {
+        CV_Error(cv::Error::StsOutOfRange, "bilateralGridFilter: sigmas and samplingScale must be positive");
+    }
+
+    // Colour images are filtered per channel with luma as the range guide
+    cv::Mat guide;
+    image.convertTo(guide, CV_32F);
+    if (image.channels() == 3) {
+        cv::cvtColor(guide, guide, cv::COLOR_BGR2GRAY);
+    }
+    double minGuide = 0, maxGuide = 0;
+    cv::minMaxLoc(guide, &minGuide, &maxGuide);
+
+    // Cells are samplingScale sigmas wide, so the grid blur has sigma 1 / samplingScale cells
+    const double cellSpace = sigmaSpace * samplingScale, cellRange = sigmaColor * samplingScale;
+    const float sigmaCells = static_cast<float>(1.0 / samplingScale);
+    const int pad = static_cast<int>(std::ceil(2 * sigmaCells));
+    std::vector<float> kernel(2 * pad + 1);
+    float kernelSum = 0;
+    for (int i = -pad; i <= pad; ++i) {
+        kernel[i + pad] = std::exp(-0.5f * i * i / (sigmaCells * sigmaCells));
+        kernelSum += kernel[i + pad];
+    }
+    for (float& w : kernel) {
+        w /= kernelSum;
+    }
+
+    const int coreHeight = cvRound((image.rows - 1) / cellSpace) + 1;
+    BilateralGrid grid;
+    grid.height = coreHeight + 2 * pad;
+    grid.width = cvRound((image.cols - 1) / cellSpace) + 1 + 2 * pad;
+    grid.depth = cvRound((maxGuide - minGuide) / cellRange) + 1 + 2 * pad;
+    grid.stride = image.channels() + 1;
+    grid.data.assign(static_cast<size_t>(grid.height) * grid.width * grid.depth * grid.stride, 0.0f);
+
+    cv::Mat result(image.size(), image.type());
+    if (image.depth() == CV_8U) {
+        splat<uchar>(image, guide, grid, cellSpace, cellRange, minGuide, pad, coreHeight);
+    } else {
+        splat<float>(image, guide, grid, cellSpace, cellRange, minGuide, pad, coreHeight);
+    }
+
+    const size_t S = grid.stride;
+    const size_t rowStride = static_cast<size_t>(grid.width) * grid.depth * S;
+    blurLines(grid, grid.height, grid.width, rowStride, grid.depth * S, S, grid.depth, kernel);
+    blurLines(grid, grid.height, grid.depth, rowStride, S, grid.depth * S, grid.width, kernel);
+    blurLines(grid, grid.width, grid.depth, grid.depth * S, S, rowStride, grid.height, kernel);
+
+    if (image.depth() == CV_8U) {
+        slice<uchar>(image, guide, grid, cellSpace, cellRange, minGuide, pad, result);
+    } else {
+        slice<float>(image, guide, grid, cellSpace, cellRange, minGuide, pad, result);
+    }
+    return result;
+}
+
+QualityStats bilateralGridError(const cv::Mat& image, double sigmaColor, double sigmaSpace, double samplingScale) {
+    // Exact reference with the window OpenCV derives from sigmaSpace
+    cv::Mat exact;
+    cv::bilateralFilter(image, exact, 0, sigmaColor, sigmaSpace);
+    const double maxValue = image.depth() == CV_8U ? 255.0 : 1.0;
+    return computeQuality(exact, bilateralGridFilter(image, sigmaColor, sigmaSpace, samplingScale), maxValue);
+}
+
+} // namespace semcv
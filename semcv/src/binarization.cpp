@@ -1,43 +1,156 @@
 #include "semcv.h"
+#include <algorithm>
 
 namespace semcv {
 
-cv::Mat globalThreshold(const cv::Mat& image, double threshold, int maxval, int type) {
-    cv::Mat gray;
+namespace {
+
+// Gray view of the input; single-channel images are used as they are (the thresholding
+// calls below never write to their source)
+cv::Mat grayView(const cv::Mat& image) {
     if (image.channels() == 3) {
+        cv::Mat gray;
         cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
-    } else {
-        gray = image.clone();
+        return gray;
+    }
+    return image;
+}
+
+// One batch of row strips; rows [first, last) are output, [readFirst, readLast) include the halo
+struct Strip {
+    int first = 0, last = 0;
+    int readFirst = 0, readLast = 0;
+    cv::Mat rows;
+    cv::Mat output;
+    std::vector<uint64_t> histogram;
+};
+
+// Strips are read and finished (written or accumulated) in order on the calling thread, so
+// readers and writers need not be thread-safe; the strips of a batch are processed in parallel
+// in between. Memory is one batch of strips plus their halo rows
+template <typename Process, typename Finish>
+void forEachStrip(cv::Size size, int stripHeight, int halo, const RowReader& readRows, Process process, Finish finish) {
+    const int batch = std::max(1, cv::getNumThreads());
+    std::vector<Strip> strips(batch);
+    for (int y = 0; y < size.height; y += batch * stripHeight) {
+        int count = 0;
+        for (; count < batch && y + count * stripHeight < size.height; ++count) {
+            Strip& strip = strips[count];
+            strip.first = y + count * stripHeight;
+            strip.last = std::min(strip.first + stripHeight, size.height);
+            strip.readFirst = std::max(strip.first - halo, 0);
+            strip.readLast = std::min(strip.last + halo, size.height);
+            strip.rows.create(strip.readLast - strip.readFirst, size.width, CV_8UC1);
+            readRows(strip.readFirst, strip.rows);
+        }
+        cv::parallel_for_(cv::Range(0, count), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                process(strips[i]);
+            }
+        });
+        for (int i = 0; i < count; ++i) {
+            finish(strips[i]);
+        }
     }
+}
+
+} // namespace
 
+cv::Mat globalThreshold(const cv::Mat& image, double threshold, int maxval, int type) {
     cv::Mat result;
-    cv::threshold(gray, result, threshold, maxval, type);
+    cv::threshold(grayView(image), result, threshold, maxval, type);
     return result;
 }
 
 cv::Mat otsuThreshold(const cv::Mat& image) {
-    cv::Mat gray;
-    if (image.channels() == 3) {
-        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
-    } else {
-        gray = image.clone();
+    cv::Mat gray = grayView(image);
+    cv::Mat result;
+    cv::threshold(gray, result, otsuThresholdValue(computeHistogram(gray)), 255, cv::THRESH_BINARY);
+    return result;
+}
+
+cv::Mat multiOtsuThreshold(const cv::Mat& image, int classes, std::vector<int>* thresholds) {
+    cv::Mat gray = grayView(image);
+    if (gray.type() != CV_8UC1) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "multiOtsuThreshold: only CV_8UC1 and CV_8UC3 images are supported");
     }
+    std::vector<int> levels = multiOtsuThresholds(computeHistogram(gray), classes);
 
+    // Labels go into a table, so the image is read once more whatever the number of classes
+    cv::Mat lookupTable(1, 256, CV_8U);
+    for (int v = 0, label = 0; v < 256; ++v) {
+        while (label < classes - 1 && v > levels[label]) {
+            ++label;
+        }
+        lookupTable.at<uchar>(v) = static_cast<uchar>(label);
+    }
+    cv::Mat labels;
+    cv::LUT(gray, lookupTable, labels);
+    if (thresholds) {
+        *thresholds = levels;
+    }
+    return labels;
+}
+
+cv::Mat adaptiveThreshold(const cv::Mat& image, int maxval, int adaptiveMethod, int type, int blockSize, double C) {
     cv::Mat result;
-    cv::threshold(gray, result, 0, 255, cv::THRESH_BINARY + cv::THRESH_OTSU);
+    cv::adaptiveThreshold(grayView(image), result, maxval, adaptiveMethod, type, blockSize, C);
     return result;
 }
 
-cv::Mat adaptiveThreshold(const cv::Mat& image, int maxval, int adaptiveMethod, int type, int blockSize, double C) {
-    cv::Mat gray;
-    if (image.channels() == 3) {
-        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
-    } else {
-        gray = image.clone();
+void binarizeStreaming(cv::Size size, const RowReader& readRows, const RowWriter& writeRows,
+                       StreamingThreshold method, int blockSize, double C, int stripHeight) {
+    if (stripHeight < 1) {
+        CV_Error(cv::Error::StsBadArg, "binarizeStreaming: stripHeight must be positive");
     }
 
-    cv::Mat result;
-    cv::adaptiveThreshold(gray, result, maxval, adaptiveMethod, type, blockSize, C);
+    auto write = [&](const Strip& strip) {
+        writeRows(strip.first, strip.output);
+    };
+
+    if (method == StreamingThreshold::Otsu) {
+        // Pass 1 builds the histogram strip by strip, pass 2 applies the global threshold
+        std::vector<uint64_t> histogram(256, 0);
+        forEachStrip(size, stripHeight, 0, readRows, [](Strip& strip) {
+            strip.histogram = computeHistogram(strip.rows);
+        }, [&](const Strip& strip) {
+            for (int v = 0; v < 256; ++v) {
+                histogram[v] += strip.histogram[v];
+            }
+        });
+        const int threshold = otsuThresholdValue(histogram);
+        forEachStrip(size, stripHeight, 0, readRows, [threshold](Strip& strip) {
+            cv::threshold(strip.rows, strip.output, threshold, 255, cv::THRESH_BINARY);
+        }, write);
+        return;
+    }
+
+    // Adaptive methods see blockSize / 2 halo rows on each side, so strip borders match the
+    // whole-image result and only the image edges are replicated
+    const int adaptiveMethod = method == StreamingThreshold::AdaptiveMean ? cv::ADAPTIVE_THRESH_MEAN_C
+                                                                          : cv::ADAPTIVE_THRESH_GAUSSIAN_C;
+    forEachStrip(size, stripHeight, blockSize / 2, readRows, [&](Strip& strip) {
+        cv::Mat binary;
+        cv::adaptiveThreshold(strip.rows, binary, 255, adaptiveMethod, cv::THRESH_BINARY, blockSize, C);
+        strip.output = binary.rowRange(strip.first - strip.readFirst, strip.last - strip.readFirst);
+    }, write);
+}
+
+cv::Mat binarizeTiled(const cv::Mat& image, StreamingThreshold method, int blockSize, double C, int stripHeight) {
+    if (image.depth() != CV_8U || (image.channels() != 1 && image.channels() != 3)) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "binarizeTiled: only CV_8UC1 and CV_8UC3 images are supported");
+    }
+    cv::Mat result(image.size(), CV_8UC1);
+    binarizeStreaming(image.size(), [&](int first, cv::Mat& rows) {
+        cv::Mat source = image.rowRange(first, first + rows.rows);
+        if (image.channels() == 3) {
+            cv::cvtColor(source, rows, cv::COLOR_BGR2GRAY);
+        } else {
+            source.copyTo(rows);
+        }
+    }, [&](int first, const cv::Mat& rows) {
+        rows.copyTo(result.rowRange(first, first + rows.rows));
+    }, method, blockSize, C, stripHeight);
     return result;
 }
 
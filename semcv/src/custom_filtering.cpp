@@ -0,0 +1,166 @@
+#include "semcv.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace semcv {
+
+namespace {
+
+const size_t maxCachedPlans = 32;
+// Singular values below this fraction of the largest one do not count towards the rank
+const double rankTolerance = 1e-6;
+// Kernels of at least this area that are not cheaply separable are filtered via FFT
+const int fftMinArea = 21 * 21;
+// Output tiles are at least this many pixels per side before rounding up to a fast DFT size
+const int minTileSize = 64;
+
+// Everything customLinearFilter needs to know about a kernel, computed once
+struct FilterPlan {
+    LinearFilterMethod method = LinearFilterMethod::Direct;
+    cv::Mat kernel;                               // CV_32F copy for the direct path
+    cv::Point anchor;
+    std::vector<std::pair<cv::Mat, cv::Mat>> terms;  // (row kernel, column kernel) per rank
+    cv::Size dftSize;                             // FFT tile size including the kernel halo
+    cv::Mat spectrum;                             // DFT of the zero-padded kernel at dftSize
+};
+
+std::shared_ptr<const FilterPlan> buildPlan(const cv::Mat& kernel) {
+    auto plan = std::make_shared<FilterPlan>();
+    kernel.convertTo(plan->kernel, CV_32F);
+    plan->anchor = cv::Point(kernel.cols / 2, kernel.rows / 2);
+
+    // Rank from the SVD: K = sum_k s_k u_k v_k^T, each term a column pass times a row pass
+    cv::Mat k64, w, u, vt;
+    kernel.convertTo(k64, CV_64F);
+    cv::SVD::compute(k64, w, u, vt);
+    int rank = 0;
+    while (rank < w.rows && w.at<double>(rank) > rankTolerance * w.at<double>(0)) {
+        ++rank;
+    }
+
+    const int area = kernel.rows * kernel.cols;
+    if (rank > 0 && 2 * rank * (kernel.rows + kernel.cols) < area) {
+        plan->method = LinearFilterMethod::Separable;
+        for (int k = 0; k < rank; ++k) {
+            cv::Mat column = u.col(k) * w.at<double>(k), row = vt.row(k);
+            cv::Mat rowKernel, columnKernel;
+            row.convertTo(rowKernel, CV_32F);
+            column.convertTo(columnKernel, CV_32F);
+            plan->terms.emplace_back(rowKernel, columnKernel);
+        }
+    } else if (area >= fftMinArea) {
+        plan->method = LinearFilterMethod::Fft;
+        const int tile = std::max(minTileSize, 2 * std::max(kernel.rows, kernel.cols));
+        plan->dftSize = cv::Size(cv::getOptimalDFTSize(tile + kernel.cols - 1), cv::getOptimalDFTSize(tile + kernel.rows - 1));
+        cv::Mat padded = cv::Mat::zeros(plan->dftSize, CV_32F);
+        plan->kernel.copyTo(padded(cv::Rect(0, 0, kernel.cols, kernel.rows)));
+        cv::dft(padded, plan->spectrum, 0, kernel.rows);
+    }
+    return plan;
+}
+
+std::shared_ptr<const FilterPlan> getFilterPlan(const cv::Mat& kernel) {
+    if (kernel.empty() || kernel.channels() != 1) {
+        CV_Error(cv::Error::StsBadArg, "customLinearFilter: kernel must be a non-empty single-channel matrix");
+    }
+    static std::mutex cacheMutex;
+    static std::map<std::string, std::shared_ptr<const FilterPlan>> cache;
+
+    // Keyed by shape, type and the raw coefficients
+    cv::Mat continuous = kernel.isContinuous() ? kernel : kernel.clone();
+    std::string key = std::to_string(kernel.rows) + "x" + std::to_string(kernel.cols) + ":" + std::to_string(kernel.type()) + ":";
+    key.append(reinterpret_cast<const char*>(continuous.data), continuous.total() * continuous.elemSize());
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    if (cache.size() >= maxCachedPlans) {
+        cache.clear();
+    }
+    auto plan = buildPlan(kernel);
+    cache.emplace(key, plan);
+    return plan;
+}
+
+cv::Mat filterSeparable(const cv::Mat& image, const FilterPlan& plan) {
+    cv::Mat result;
+    if (plan.terms.size() == 1) {
+        cv::sepFilter2D(image, result, -1, plan.terms[0].first, plan.terms[0].second, plan.anchor);
+        return result;
+    }
+    // Low-rank kernels: the terms are summed in float and rounded once
+    cv::Mat sum, term;
+    for (const auto& t : plan.terms) {
+        cv::sepFilter2D(image, term, CV_32F, t.first, t.second, plan.anchor);
+        if (sum.empty()) {
+            sum = term.clone();
+        } else {
+            sum += term;
+        }
+    }
+    sum.convertTo(result, image.depth());
+    return result;
+}
+
+// Tiled overlap-save: each tile of the border-extended image is transformed at the plan's DFT
+// size and multiplied by the conjugate kernel spectrum (correlation, like filter2D). The first
+// tile-size outputs are free of wrap-around, so tiles are independent and run in parallel
+cv::Mat filterFft(const cv::Mat& image, const FilterPlan& plan) {
+    const int kh = plan.kernel.rows, kw = plan.kernel.cols, cn = image.channels();
+    cv::Mat source, padded;
+    image.convertTo(source, CV_32F);
+    cv::copyMakeBorder(source, padded, plan.anchor.y, kh - 1 - plan.anchor.y, plan.anchor.x, kw - 1 - plan.anchor.x,
+                       cv::BORDER_REFLECT_101);
+
+    const int tileW = plan.dftSize.width - (kw - 1), tileH = plan.dftSize.height - (kh - 1);
+    const int tilesX = (image.cols + tileW - 1) / tileW, tilesY = (image.rows + tileH - 1) / tileH;
+    cv::Mat output(image.size(), CV_32FC(cn));
+    cv::parallel_for_(cv::Range(0, tilesX * tilesY * cn), [&](const cv::Range& range) {
+        cv::Mat block, spectrum, filtered;
+        for (int task = range.start; task < range.end; ++task) {
+            const int c = task % cn, t = task / cn;
+            const int x = (t % tilesX) * tileW, y = (t / tilesX) * tileH;
+            const int outW = std::min(tileW, image.cols - x), outH = std::min(tileH, image.rows - y);
+
+            block = cv::Mat::zeros(plan.dftSize, CV_32F);
+            cv::Mat window = padded(cv::Rect(x, y, outW + kw - 1, outH + kh - 1));
+            cv::extractChannel(window, block(cv::Rect(0, 0, window.cols, window.rows)), c);
+            cv::dft(block, spectrum, 0, window.rows);
+            cv::mulSpectrums(spectrum, plan.spectrum, spectrum, 0, true);
+            cv::idft(spectrum, filtered, cv::DFT_SCALE | cv::DFT_REAL_OUTPUT, outH);
+            cv::insertChannel(filtered(cv::Rect(0, 0, outW, outH)), output(cv::Rect(x, y, outW, outH)), c);
+        }
+    });
+
+    cv::Mat result;
+    output.convertTo(result, image.depth());
+    return result;
+}
+
+} // namespace
+
+LinearFilterMethod linearFilterMethod(const cv::Mat& kernel) {
+    return getFilterPlan(kernel)->method;
+}
+
+cv::Mat customLinearFilter(const cv::Mat& image, const cv::Mat& kernel) {
+    auto plan = getFilterPlan(kernel);
+    switch (plan->method) {
+        case LinearFilterMethod::Separable:
+            return filterSeparable(image, *plan);
+        case LinearFilterMethod::Fft:
+            return filterFft(image, *plan);
+        default: {
+            cv::Mat result;
+            cv::filter2D(image, result, -1, kernel);
+            return result;
+        }
+    }
+}
+
+} // namespace semcv
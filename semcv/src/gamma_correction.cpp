@@ -1,32 +1,224 @@
 #include "semcv.h"
 #include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace semcv {
 
-cv::Mat gammaCorrection(const cv::Mat& image, double gamma) {
+namespace {
+
+// Cache is cleared when it grows past this many tables
+const size_t maxCachedLUTs = 256;
+
+cv::Mat buildGammaLUT(double gamma, int depth) {
+    if (depth == CV_16U) {
+        cv::Mat lookupTable(1, 65536, CV_16U);
+        ushort* p = lookupTable.ptr<ushort>();
+        for (int i = 0; i < 65536; ++i) {
+            p[i] = cv::saturate_cast<ushort>(pow(i / 65535.0, 1.0 / gamma) * 65535.0);
+        }
+        return lookupTable;
+    }
+
     cv::Mat lookupTable(1, 256, CV_8U);
     uchar* p = lookupTable.ptr();
-
     for (int i = 0; i < 256; ++i) {
         p[i] = cv::saturate_cast<uchar>(pow(i / 255.0, 1.0 / gamma) * 255.0);
     }
+    return lookupTable;
+}
 
-    cv::Mat result;
-    cv::LUT(image, lookupTable, result);
-    return result;
+// log2 via exponent extraction and the atanh series on a mantissa in [sqrt(0.5), sqrt(2))
+inline float fastLog2(float x) {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127;
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    if (m > 1.41421356f) {
+        m *= 0.5f;
+        exponent += 1;
+    }
+    float t = (m - 1.0f) / (m + 1.0f);
+    float t2 = t * t;
+    float ln = t * (2.0f + t2 * (2.0f / 3.0f + t2 * (2.0f / 5.0f + t2 * (2.0f / 7.0f))));
+    return static_cast<float>(exponent) + ln * 1.44269504f;
 }
 
-cv::Mat gammaCorrection(const cv::Mat& image, double gamma, cv::Mat& lookupTable) {
-    lookupTable = cv::Mat(1, 256, CV_8U);
-    uchar* p = lookupTable.ptr();
+// 2^y via integer scaling and a degree-6 Taylor polynomial on the fraction
+inline float fastExp2(float y) {
+    float clamped = std::min(std::max(y, -126.0f), 127.0f);
+    float n = std::floor(clamped + 0.5f);
+    float f = (clamped - n) * 0.69314718f;
+    float p = 1.0f + f * (1.0f + f * (0.5f + f * (1.0f / 6.0f + f * (1.0f / 24.0f +
+              f * (1.0f / 120.0f + f * (1.0f / 720.0f))))));
+    uint32_t bits = static_cast<uint32_t>(static_cast<int>(n) + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return y < -126.0f ? 0.0f : p * scale;
+}
 
-    for (int i = 0; i < 256; ++i) {
-        p[i] = cv::saturate_cast<uchar>(pow(i / 255.0, 1.0 / gamma) * 255.0);
+void applyLUT16u(const cv::Mat& image, const cv::Mat& lookupTable, cv::Mat& result) {
+    result.create(image.size(), image.type());
+    const ushort* lut = lookupTable.ptr<ushort>();
+    const int width = image.cols * image.channels();
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const ushort* src = image.ptr<ushort>(y);
+            ushort* dst = result.ptr<ushort>(y);
+            for (int x = 0; x < width; ++x) {
+                dst[x] = lut[src[x]];
+            }
+        }
+    });
+}
+
+void applyGamma32f(const cv::Mat& image, double gamma, cv::Mat& result) {
+    result.create(image.size(), image.type());
+    const float exponent = static_cast<float>(1.0 / gamma);
+    const int width = image.cols * image.channels();
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const float* src = image.ptr<float>(y);
+            float* dst = result.ptr<float>(y);
+            for (int x = 0; x < width; ++x) {
+                dst[x] = fastPow(src[x], exponent);
+            }
+        }
+    });
+}
+
+template <typename T>
+void applyLUTsMulti(const cv::Mat& image, const std::vector<cv::Mat>& tables, std::vector<cv::Mat>& results) {
+    const int width = image.cols * image.channels();
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            // The source row stays in L1 while every output row is written from it
+            const T* src = image.ptr<T>(y);
+            for (size_t k = 0; k < tables.size(); ++k) {
+                const T* lut = tables[k].ptr<T>();
+                T* dst = results[k].ptr<T>(y);
+                for (int x = 0; x < width; ++x) {
+                    dst[x] = lut[src[x]];
+                }
+            }
+        }
+    });
+}
+
+void applyGamma32fMulti(const cv::Mat& image, const std::vector<double>& gammas, std::vector<cv::Mat>& results) {
+    const int width = image.cols * image.channels();
+    std::vector<float> exponents;
+    for (double gamma : gammas) {
+        exponents.push_back(static_cast<float>(1.0 / gamma));
     }
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        // log2 is shared by all gammas, only exp2 is evaluated per output
+        std::vector<float> logs(width);
+        for (int y = range.start; y < range.end; ++y) {
+            const float* src = image.ptr<float>(y);
+            for (int x = 0; x < width; ++x) {
+                logs[x] = fastLog2(std::max(src[x], 1.17549435e-38f));
+            }
+            for (size_t k = 0; k < exponents.size(); ++k) {
+                float* dst = results[k].ptr<float>(y);
+                for (int x = 0; x < width; ++x) {
+                    float value = fastExp2(exponents[k] * logs[x]);
+                    dst[x] = src[x] >= 1.17549435e-38f ? value : 0.0f;
+                }
+            }
+        }
+    });
+}
 
+} // namespace
+
+float fastPow(float x, float p) {
+    // Non-positive and denormal inputs map to 0 (pow(0, p) for p > 0)
+    float value = fastExp2(p * fastLog2(std::max(x, 1.17549435e-38f)));
+    return x >= 1.17549435e-38f ? value : 0.0f;
+}
+
+cv::Mat getGammaLUT(double gamma, int depth) {
+    if (depth != CV_8U && depth != CV_16U) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "getGammaLUT: only CV_8U and CV_16U tables are supported");
+    }
+
+    static std::mutex cacheMutex;
+    static std::map<std::pair<double, int>, cv::Mat> cache;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto key = std::make_pair(gamma, depth);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    if (cache.size() >= maxCachedLUTs) {
+        cache.clear();
+    }
+    cv::Mat lookupTable = buildGammaLUT(gamma, depth);
+    cache.emplace(key, lookupTable);
+    return lookupTable;
+}
+
+cv::Mat gammaCorrection(const cv::Mat& image, double gamma) {
     cv::Mat result;
-    cv::LUT(image, lookupTable, result);
+    switch (image.depth()) {
+        case CV_8U:
+            cv::LUT(image, getGammaLUT(gamma, CV_8U), result);
+            break;
+        case CV_16U:
+            applyLUT16u(image, getGammaLUT(gamma, CV_16U), result);
+            break;
+        case CV_32F:
+            applyGamma32f(image, gamma, result);
+            break;
+        default:
+            CV_Error(cv::Error::StsUnsupportedFormat, "gammaCorrection: only CV_8U, CV_16U and CV_32F images are supported");
+    }
     return result;
 }
 
+std::vector<cv::Mat> gammaCorrectionMulti(const cv::Mat& image, const std::vector<double>& gammas) {
+    std::vector<cv::Mat> results(gammas.size());
+    for (auto& result : results) {
+        result.create(image.size(), image.type());
+    }
+    if (image.empty() || gammas.empty()) {
+        return results;
+    }
+
+    switch (image.depth()) {
+        case CV_8U:
+        case CV_16U: {
+            std::vector<cv::Mat> tables;
+            for (double gamma : gammas) {
+                tables.push_back(getGammaLUT(gamma, image.depth()));
+            }
+            if (image.depth() == CV_8U) {
+                applyLUTsMulti<uchar>(image, tables, results);
+            } else {
+                applyLUTsMulti<ushort>(image, tables, results);
+            }
+            break;
+        }
+        case CV_32F:
+            applyGamma32fMulti(image, gammas, results);
+            break;
+        default:
+            CV_Error(cv::Error::StsUnsupportedFormat, "gammaCorrectionMulti: only CV_8U, CV_16U and CV_32F images are supported");
+    }
+    return results;
+}
+
+cv::Mat gammaCorrection(const cv::Mat& image, double gamma, cv::Mat& lookupTable) {
+    // Callers may modify the returned table, so hand out a copy of the cached one
+    lookupTable = getGammaLUT(gamma, image.depth() == CV_16U ? CV_16U : CV_8U).clone();
+    return gammaCorrection(image, gamma);
+}
+
 } // namespace semcv
@@ -0,0 +1,225 @@
+#include "semcv.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+
+namespace semcv {
+
+namespace {
+
+// Stripes smaller than this are not worth a separate task
+const size_t minSamplesPerStripe = 1 << 16;
+// 32-bit bank counters are flushed into the 64-bit result before they can overflow
+const uint64_t maxPendingSamples = 1u << 31;
+
+// Consecutive samples go to different banks, so runs of equal values do not
+// serialize on a single counter
+template <typename T, int Banks>
+void accumulateRows(const cv::Mat& image, const cv::Range& rows, bool perChannel, uint64_t* result) {
+    const int bins = 1 << (8 * sizeof(T));
+    const int cn = image.channels();
+    const int histograms = perChannel ? cn : 1;
+    const int width = image.cols * cn;
+    const size_t bankSize = static_cast<size_t>(histograms) * bins;
+
+    std::vector<uint32_t> banks(Banks * bankSize, 0);
+    uint64_t pending = 0;
+
+    auto flush = [&]() {
+        for (int b = 0; b < Banks; ++b) {
+            const uint32_t* bank = banks.data() + b * bankSize;
+            for (size_t i = 0; i < bankSize; ++i) {
+                result[i] += bank[i];
+            }
+        }
+        std::fill(banks.begin(), banks.end(), 0);
+        pending = 0;
+    };
+
+    for (int y = rows.start; y < rows.end; ++y) {
+        if (pending + width > maxPendingSamples) {
+            flush();
+        }
+        const T* src = image.ptr<T>(y);
+        if (!perChannel) {
+            for (int i = 0; i < width; ++i) {
+                banks[(i & (Banks - 1)) * bankSize + src[i]]++;
+            }
+        } else {
+            for (int x = 0, i = 0; x < image.cols; ++x) {
+                uint32_t* bank = banks.data() + (x & (Banks - 1)) * bankSize;
+                for (int c = 0; c < cn; ++c, ++i) {
+                    bank[c * bins + src[i]]++;
+                }
+            }
+        }
+        pending += width;
+    }
+    flush();
+}
+
+// Per-stripe partial histograms followed by a reduction that is parallel over bins
+std::vector<uint64_t> histogramImpl(const cv::Mat& image, bool perChannel) {
+    if (image.depth() != CV_8U && image.depth() != CV_16U) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "histogram: only CV_8U and CV_16U images are supported");
+    }
+    const int bins = image.depth() == CV_8U ? 256 : 65536;
+    const size_t size = static_cast<size_t>(perChannel ? image.channels() : 1) * bins;
+    if (image.empty()) {
+        return std::vector<uint64_t>(size, 0);
+    }
+
+    const size_t samples = image.total() * image.channels();
+    const int stripes = static_cast<int>(std::min<size_t>({
+        static_cast<size_t>(image.rows),
+        static_cast<size_t>(std::max(cv::getNumThreads(), 1)) * 2,
+        std::max<size_t>(samples / minSamplesPerStripe, 1)}));
+
+    std::vector<uint64_t> partials(static_cast<size_t>(stripes) * size, 0);
+    cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s) {
+            cv::Range rows(image.rows * s / stripes, image.rows * (s + 1) / stripes);
+            uint64_t* partial = partials.data() + s * size;
+            if (image.depth() == CV_8U) {
+                accumulateRows<uchar, 4>(image, rows, perChannel, partial);
+            } else {
+                accumulateRows<ushort, 2>(image, rows, perChannel, partial);
+            }
+        }
+    });
+
+    if (stripes == 1) {
+        return partials;
+    }
+    std::vector<uint64_t> result(size, 0);
+    cv::parallel_for_(cv::Range(0, static_cast<int>(size)), [&](const cv::Range& range) {
+        for (int s = 0; s < stripes; ++s) {
+            const uint64_t* partial = partials.data() + s * size;
+            for (int i = range.start; i < range.end; ++i) {
+                result[i] += partial[i];
+            }
+        }
+    });
+    return result;
+}
+
+} // namespace
+
+std::vector<uint64_t> computeHistogram(const cv::Mat& image) {
+    return histogramImpl(image, false);
+}
+
+std::vector<std::vector<uint64_t>> computeChannelHistograms(const cv::Mat& image) {
+    std::vector<uint64_t> joined = histogramImpl(image, true);
+    const size_t bins = joined.size() / image.channels();
+    std::vector<std::vector<uint64_t>> result;
+    for (int c = 0; c < image.channels(); ++c) {
+        result.emplace_back(joined.begin() + c * bins, joined.begin() + (c + 1) * bins);
+    }
+    return result;
+}
+
+std::vector<uint64_t> cumulativeHistogram(const std::vector<uint64_t>& histogram) {
+    std::vector<uint64_t> cumulative(histogram.size(), 0);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < histogram.size(); ++i) {
+        sum += histogram[i];
+        cumulative[i] = sum;
+    }
+    return cumulative;
+}
+
+int histogramPercentile(const std::vector<uint64_t>& cumulative, double percent) {
+    if (cumulative.empty()) {
+        return 0;
+    }
+    const uint64_t total = cumulative.back();
+    const double target = std::min(std::max(percent, 0.0), 100.0) / 100.0 * total;
+    auto it = std::lower_bound(cumulative.begin(), cumulative.end(), target,
+                               [](uint64_t count, double value) { return count < value; });
+    return static_cast<int>(std::min<ptrdiff_t>(it - cumulative.begin(), cumulative.size() - 1));
+}
+
+int otsuThresholdValue(const std::vector<uint64_t>& histogram) {
+    // Same search as cv::threshold with THRESH_OTSU, so results match it exactly
+    uint64_t total = 0;
+    double mu = 0.0;
+    for (size_t i = 0; i < histogram.size(); ++i) {
+        total += histogram[i];
+        mu += i * static_cast<double>(histogram[i]);
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const double scale = 1.0 / total;
+    mu *= scale;
+
+    double q1 = 0.0, mu1 = 0.0, maxSigma = 0.0;
+    int maxValue = 0;
+    for (size_t i = 0; i < histogram.size(); ++i) {
+        double p = histogram[i] * scale;
+        mu1 *= q1;
+        q1 += p;
+        double q2 = 1.0 - q1;
+        if (std::min(q1, q2) < FLT_EPSILON || std::max(q1, q2) > 1.0 - FLT_EPSILON) {
+            continue;
+        }
+        mu1 = (mu1 + i * p) / q1;
+        double mu2 = (mu - q1 * mu1) / q2;
+        double sigma = q1 * q2 * (mu1 - mu2) * (mu1 - mu2);
+        if (sigma > maxSigma) {
+            maxSigma = sigma;
+            maxValue = static_cast<int>(i);
+        }
+    }
+    return maxValue;
+}
+
+std::vector<int> multiOtsuThresholds(const std::vector<uint64_t>& histogram, int classes) {
+    const int levels = static_cast<int>(histogram.size());
+    if (classes < 2 || classes > levels) {
+        CV_Error(cv::Error::StsOutOfRange, "multiOtsuThresholds: classes must be between 2 and the number of bins");
+    }
+
+    // Prefix counts and first moments: a class of bins [a, b) contributes (S_b - S_a)^2 / (P_b - P_a)
+    // to the between-class variance, up to terms that do not depend on the split
+    std::vector<double> count(levels + 1, 0.0), moment(levels + 1, 0.0);
+    for (int i = 0; i < levels; ++i) {
+        count[i + 1] = count[i] + static_cast<double>(histogram[i]);
+        moment[i + 1] = moment[i] + i * static_cast<double>(histogram[i]);
+    }
+    auto classScore = [&](int a, int b) {
+        const double p = count[b] - count[a];
+        const double m = moment[b] - moment[a];
+        return p > 0 ? m * m / p : 0.0;
+    };
+
+    // best[k][i]: best score splitting bins [0, i) into k + 1 classes; start[k][i] is where the
+    // last of them begins. Ties keep the smallest start, like otsuThresholdValue
+    std::vector<std::vector<double>> best(classes, std::vector<double>(levels + 1, -1.0));
+    std::vector<std::vector<int>> start(classes, std::vector<int>(levels + 1, 0));
+    for (int i = 1; i <= levels; ++i) {
+        best[0][i] = classScore(0, i);
+    }
+    for (int k = 1; k < classes; ++k) {
+        for (int i = k + 1; i <= levels; ++i) {
+            for (int j = k; j < i; ++j) {
+                const double score = best[k - 1][j] + classScore(j, i);
+                if (score > best[k][i]) {
+                    best[k][i] = score;
+                    start[k][i] = j;
+                }
+            }
+        }
+    }
+
+    // Class k starts at bin j, so values up to j - 1 belong below it (as with THRESH_BINARY)
+    std::vector<int> thresholds(classes - 1);
+    for (int k = classes - 1, i = levels; k > 0; --k) {
+        i = start[k][i];
+        thresholds[k - 1] = i - 1;
+    }
+    return thresholds;
+}
+
+} // namespace semcv
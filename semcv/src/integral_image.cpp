@@ -0,0 +1,211 @@
+#include "semcv.h"
+#include <algorithm>
+#include <cmath>
+
+namespace semcv {
+
+namespace {
+
+// Window [x - r, x + r] clipped to the image, as half-open bounds
+inline void clippedWindow(int center, int radius, int size, int& first, int& last) {
+    first = std::max(center - radius, 0);
+    last = std::min(center + radius + 1, size);
+}
+
+template <typename T>
+void integrateStripe(const cv::Mat& image, int y0, int y1, int64_t* sums, int64_t* squareSums) {
+    const size_t stride = image.cols + 1;
+    for (int y = y0; y < y1; ++y) {
+        const T* src = image.ptr<T>(y);
+        int64_t* s = sums + (y + 1) * stride;
+        int64_t* q = squareSums + (y + 1) * stride;
+        // The row above belongs to this stripe only if y > y0; stripes start from zero
+        const int64_t* sAbove = y > y0 ? s - stride : nullptr;
+        const int64_t* qAbove = y > y0 ? q - stride : nullptr;
+        int64_t rowSum = 0, rowSquareSum = 0;
+        s[0] = q[0] = 0;
+        for (int x = 0; x < image.cols; ++x) {
+            const int64_t v = src[x];
+            rowSum += v;
+            rowSquareSum += v * v;
+            s[x + 1] = sAbove ? sAbove[x + 1] + rowSum : rowSum;
+            q[x + 1] = qAbove ? qAbove[x + 1] + rowSquareSum : rowSquareSum;
+        }
+    }
+}
+
+// Threshold from the local mean and standard deviation, evaluated per pixel without
+// materialising the statistics; foreground (above threshold) becomes 255
+template <typename T, typename Rule>
+void localThreshold(const cv::Mat& gray, const IntegralImage& integral, int blockSize, cv::Mat& result, Rule rule) {
+    const int radius = blockSize / 2;
+    cv::parallel_for_(cv::Range(0, gray.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const T* src = gray.ptr<T>(y);
+            uchar* dst = result.ptr(y);
+            int y0, y1;
+            clippedWindow(y, radius, gray.rows, y0, y1);
+            for (int x = 0; x < gray.cols; ++x) {
+                int x0, x1;
+                clippedWindow(x, radius, gray.cols, x0, x1);
+                const cv::Rect window(x0, y0, x1 - x0, y1 - y0);
+                const double area = window.area();
+                const double mean = integral.sum(window) / area;
+                const double variance = std::max(integral.squareSum(window) / area - mean * mean, 0.0);
+                dst[x] = src[x] > rule(mean, std::sqrt(variance)) ? 255 : 0;
+            }
+        }
+    });
+}
+
+template <typename Rule>
+cv::Mat localThreshold(const cv::Mat& gray, const IntegralImage& integral, int blockSize, Rule rule) {
+    if (gray.channels() != 1 || gray.rows != integral.rows() || gray.cols != integral.cols()) {
+        CV_Error(cv::Error::StsUnmatchedSizes, "localThreshold: image must be single-channel and match the integral image");
+    }
+    if (blockSize < 3 || blockSize % 2 == 0) {
+        CV_Error(cv::Error::StsBadArg, "localThreshold: blockSize must be odd and at least 3");
+    }
+    cv::Mat result(gray.size(), CV_8UC1);
+    if (gray.depth() == CV_8U) {
+        localThreshold<uchar>(gray, integral, blockSize, result, rule);
+    } else {
+        localThreshold<ushort>(gray, integral, blockSize, result, rule);
+    }
+    return result;
+}
+
+} // namespace
+
+IntegralImage::IntegralImage(const cv::Mat& image) : height(image.rows), width(image.cols) {
+    if (image.channels() != 1 || (image.depth() != CV_8U && image.depth() != CV_16U)) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "IntegralImage: only single-channel CV_8U and CV_16U images are supported");
+    }
+    const size_t stride = width + 1;
+    sums.assign((height + 1) * stride, 0);
+    squareSums.assign((height + 1) * stride, 0);
+
+    // Each stripe integrates its rows on its own, then the stripe totals above it are added
+    const int stripes = std::max(1, std::min(height, cv::getNumThreads()));
+    cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s) {
+            const int y0 = height * s / stripes, y1 = height * (s + 1) / stripes;
+            if (image.depth() == CV_8U) {
+                integrateStripe<uchar>(image, y0, y1, sums.data(), squareSums.data());
+            } else {
+                integrateStripe<ushort>(image, y0, y1, sums.data(), squareSums.data());
+            }
+        }
+    });
+
+    std::vector<int64_t> carry(stripes * stride, 0), squareCarry(stripes * stride, 0);
+    for (int s = 1; s < stripes; ++s) {
+        const size_t last = static_cast<size_t>(height * s / stripes) * stride;
+        for (size_t x = 0; x < stride; ++x) {
+            carry[s * stride + x] = carry[(s - 1) * stride + x] + sums[last + x];
+            squareCarry[s * stride + x] = squareCarry[(s - 1) * stride + x] + squareSums[last + x];
+        }
+    }
+    cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+        for (int s = std::max(range.start, 1); s < range.end; ++s) {
+            for (int y = height * s / stripes; y < height * (s + 1) / stripes; ++y) {
+                int64_t* row = &sums[(y + 1) * stride];
+                int64_t* squareRow = &squareSums[(y + 1) * stride];
+                for (size_t x = 0; x < stride; ++x) {
+                    row[x] += carry[s * stride + x];
+                    squareRow[x] += squareCarry[s * stride + x];
+                }
+            }
+        }
+    });
+}
+
+int64_t IntegralImage::sum(const cv::Rect& rect) const {
+    const size_t stride = width + 1;
+    const size_t top = rect.y * stride, bottom = (rect.y + rect.height) * stride;
+    return sums[bottom + rect.x + rect.width] - sums[bottom + rect.x] - sums[top + rect.x + rect.width] + sums[top + rect.x];
+}
+
+int64_t IntegralImage::squareSum(const cv::Rect& rect) const {
+    const size_t stride = width + 1;
+    const size_t top = rect.y * stride, bottom = (rect.y + rect.height) * stride;
+    return squareSums[bottom + rect.x + rect.width] - squareSums[bottom + rect.x] -
+           squareSums[top + rect.x + rect.width] + squareSums[top + rect.x];
+}
+
+void IntegralImage::boxMeanVariance(cv::Size window, cv::Mat& mean, cv::Mat& variance) const {
+    const int rx = window.width / 2, ry = window.height / 2;
+    mean.create(height, width, CV_32F);
+    variance.create(height, width, CV_32F);
+    cv::parallel_for_(cv::Range(0, height), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            float* m = mean.ptr<float>(y);
+            float* v = variance.ptr<float>(y);
+            int y0, y1;
+            clippedWindow(y, ry, height, y0, y1);
+            for (int x = 0; x < width; ++x) {
+                int x0, x1;
+                clippedWindow(x, rx, width, x0, x1);
+                const cv::Rect rect(x0, y0, x1 - x0, y1 - y0);
+                const double area = rect.area();
+                const double mu = sum(rect) / area;
+                m[x] = static_cast<float>(mu);
+                v[x] = static_cast<float>(std::max(squareSum(rect) / area - mu * mu, 0.0));
+            }
+        }
+    });
+}
+
+cv::Mat IntegralImage::boxMean(cv::Size window) const {
+    const int rx = window.width / 2, ry = window.height / 2;
+    cv::Mat mean(height, width, CV_32F);
+    cv::parallel_for_(cv::Range(0, height), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            float* m = mean.ptr<float>(y);
+            int y0, y1;
+            clippedWindow(y, ry, height, y0, y1);
+            for (int x = 0; x < width; ++x) {
+                int x0, x1;
+                clippedWindow(x, rx, width, x0, x1);
+                const cv::Rect rect(x0, y0, x1 - x0, y1 - y0);
+                m[x] = static_cast<float>(static_cast<double>(sum(rect)) / rect.area());
+            }
+        }
+    });
+    return mean;
+}
+
+cv::Mat niblackThreshold(const cv::Mat& gray, const IntegralImage& integral, int blockSize, double k) {
+    return localThreshold(gray, integral, blockSize, [k](double mean, double stddev) {
+        return mean + k * stddev;
+    });
+}
+
+cv::Mat sauvolaThreshold(const cv::Mat& gray, const IntegralImage& integral, int blockSize, double k, double R) {
+    return localThreshold(gray, integral, blockSize, [k, R](double mean, double stddev) {
+        return mean * (1.0 + k * (stddev / R - 1.0));
+    });
+}
+
+cv::Mat bradleyThreshold(const cv::Mat& gray, const IntegralImage& integral, int blockSize, double t) {
+    return localThreshold(gray, integral, blockSize, [t](double mean, double) {
+        return mean * (1.0 - t);
+    });
+}
+
+cv::Mat niblackThreshold(const cv::Mat& image, int blockSize, double k) {
+    cv::Mat gray = image.channels() == 3 ? convertToGrayscale(image) : image;
+    return niblackThreshold(gray, IntegralImage(gray), blockSize, k);
+}
+
+cv::Mat sauvolaThreshold(const cv::Mat& image, int blockSize, double k, double R) {
+    cv::Mat gray = image.channels() == 3 ? convertToGrayscale(image) : image;
+    return sauvolaThreshold(gray, IntegralImage(gray), blockSize, k, R);
+}
+
+cv::Mat bradleyThreshold(const cv::Mat& image, int blockSize, double t) {
+    cv::Mat gray = image.channels() == 3 ? convertToGrayscale(image) : image;
+    return bradleyThreshold(gray, IntegralImage(gray), blockSize, t);
+}
+
+} // namespace semcv
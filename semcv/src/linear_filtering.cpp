@@ -1,10 +1,29 @@
 #include "semcv.h"
+#include <algorithm>
 
 namespace semcv {
 
+namespace {
+
+// Grid cells (sigmaSpace pixels at the default sampling) at least this wide replace the exact
+// bilateral filter; below it the grid saves little and the exact window is cheap anyway
+const double bilateralGridMinCell = 8.0;
+// From this sigma on the recursive Gaussian beats GaussianBlur (see benchmarkGaussianFilters)
+const double recursiveGaussianMinSigma = 8.0;
+
+} // namespace
+
 cv::Mat gaussianFilter(const cv::Mat& image, cv::Size kernelSize, double sigmaX, double sigmaY) {
     if (sigmaY == 0) sigmaY = sigmaX;
 
+    // An explicit kernel narrower than +-3 sigma is a deliberately truncated filter; keep it FIR
+    const bool fullWidth = (kernelSize.width == 0 || kernelSize.width >= 6 * sigmaX) &&
+                           (kernelSize.height == 0 || kernelSize.height >= 6 * sigmaY);
+    if (fullWidth && std::max(sigmaX, sigmaY) >= recursiveGaussianMinSigma && std::min(sigmaX, sigmaY) >= 0.5 &&
+        image.channels() <= 4) {
+        return recursiveGaussianFilter(image, sigmaX, sigmaY, cv::BORDER_REFLECT_101);
+    }
+
     cv::Mat result;
     cv::GaussianBlur(image, result, kernelSize, sigmaX, sigmaY);
     return result;
@@ -17,21 +36,21 @@ cv::Mat boxFilter(const cv::Mat& image, cv::Size kernelSize) {
 }
 
 cv::Mat medianFilter(const cv::Mat& image, int kernelSize) {
-    cv::Mat result;
-    cv::medianBlur(image, result, kernelSize);
-    return result;
+    return medianFilter(image, cv::Size(kernelSize, kernelSize));
 }
 
 cv::Mat bilateralFilter(const cv::Mat& image, int d, double sigmaColor, double sigmaSpace) {
+    // A window narrower than the one OpenCV derives from sigmaSpace is a deliberately truncated
+    // filter, which the grid does not model; keep it exact
+    const int fullDiameter = 2 * cvRound(sigmaSpace * 1.5) + 1;
+    const bool fullWidth = d <= 0 || d >= fullDiameter;
+    if (fullWidth && sigmaSpace >= bilateralGridMinCell && (image.depth() == CV_8U || image.depth() == CV_32F) &&
+        (image.channels() == 1 || image.channels() == 3)) {
+        return bilateralGridFilter(image, sigmaColor, sigmaSpace);
+    }
     cv::Mat result;
     cv::bilateralFilter(image, result, d, sigmaColor, sigmaSpace);
     return result;
 }
 
-cv::Mat customLinearFilter(const cv::Mat& image, const cv::Mat& kernel) {
-    cv::Mat result;
-    cv::filter2D(image, result, -1, kernel);
-    return result;
-}
-
 } // namespace semcv
@@ -0,0 +1,289 @@
+#include "semcv.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace semcv {
+
+namespace {
+
+// An extreme value counts as an impulse unless its 8-connected region of equal pixels has at
+// least this many pixels. Unlike a count over a fixed neighbourhood, a saturated region keeps
+// its corners when noise hits the pixels next to them; salt and pepper clusters stay far
+// smaller than this at the usual densities
+const int minRegionArea = 16;
+
+template <typename T>
+void detectImpulses(const cv::Mat& image, cv::Mat& impulses) {
+    const int cn = image.channels();
+    const double extremes[2] = {0.0, static_cast<double>(std::numeric_limits<T>::max())};
+    impulses = cv::Mat::zeros(image.rows, image.cols * cn, CV_8U);
+    cv::Mat channel, equal, labels, stats, centroids;
+    for (int c = 0; c < cn; ++c) {
+        cv::extractChannel(image, channel, c);
+        for (double value : extremes) {
+            cv::compare(channel, value, equal, cv::CMP_EQ);
+            const int count = cv::connectedComponentsWithStats(equal, labels, stats, centroids, 8, CV_32S);
+            std::vector<uchar> small(count, 0);
+            for (int label = 1; label < count; ++label) {
+                small[label] = stats.at<int>(label, cv::CC_STAT_AREA) < minRegionArea;
+            }
+            cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+                for (int y = range.start; y < range.end; ++y) {
+                    const int* label = labels.ptr<int>(y);
+                    uchar* mask = impulses.ptr(y);
+                    for (int x = 0; x < image.cols; ++x) {
+                        if (small[label[x]]) {
+                            mask[x * cn + c] = 1;
+                        }
+                    }
+                }
+            });
+        }
+    }
+}
+
+// Median of the clean samples in the smallest window (3, 5, ... maxKernelSize) that has
+// any; if even the largest window is all impulses, the median of that whole window
+template <typename T>
+void replaceImpulses(const cv::Mat& image, const cv::Mat& impulses, cv::Mat& result, int maxKernelSize) {
+    const int cn = image.channels();
+    const int width = image.cols * cn;
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        std::vector<T> clean, all;
+        for (int y = range.start; y < range.end; ++y) {
+            const uchar* mask = impulses.ptr(y);
+            T* dst = result.ptr<T>(y);
+            for (int i = 0; i < width; ++i) {
+                if (!mask[i]) {
+                    continue;
+                }
+                const int x = i / cn, c = i % cn;
+                for (int radius = 1; radius <= maxKernelSize / 2; ++radius) {
+                    clean.clear();
+                    all.clear();
+                    for (int yy = std::max(0, y - radius); yy <= std::min(image.rows - 1, y + radius); ++yy) {
+                        const T* row = image.ptr<T>(yy);
+                        const uchar* rowMask = impulses.ptr(yy);
+                        for (int xx = std::max(0, x - radius); xx <= std::min(image.cols - 1, x + radius); ++xx) {
+                            const int j = xx * cn + c;
+                            all.push_back(row[j]);
+                            if (!rowMask[j]) {
+                                clean.push_back(row[j]);
+                            }
+                        }
+                    }
+                    if (!clean.empty() || radius == maxKernelSize / 2) {
+                        std::vector<T>& samples = clean.empty() ? all : clean;
+                        auto middle = samples.begin() + samples.size() / 2;
+                        std::nth_element(samples.begin(), middle, samples.end());
+                        dst[i] = *middle;
+                        break;
+                    }
+                }
+            }
+        }
+    });
+}
+
+// Output columns per strip; each strip keeps its own column histograms
+const int minStripWidth = 64;
+
+inline int clampIndex(int i, int size) {
+    return std::min(std::max(i, 0), size - 1);
+}
+
+// Perreault-Hebert constant-time median for one channel of an 8-bit strip. Column
+// histograms cover the window height and move down one row at a time; the kernel
+// histogram is a coarse (high nibble) level updated per column step plus fine levels
+// that are brought up to date only when the median search enters their coarse bin.
+// Borders are replicated like cv::medianBlur
+void medianStrip8u(const cv::Mat& image, cv::Mat& result, int channel, int x0, int x1, int rx, int ry) {
+    const int cn = image.channels();
+    const int columns = x1 - x0 + 2 * rx;
+    const int span = 2 * rx + 1;
+    const uint32_t rank = static_cast<uint32_t>(span) * (2 * ry + 1) / 2;
+
+    std::vector<uint16_t> colCoarse(static_cast<size_t>(columns) * 16, 0);
+    std::vector<uint16_t> colFine(static_cast<size_t>(columns) * 256, 0);
+    std::vector<int> sourceX(columns);
+    for (int j = 0; j < columns; ++j) {
+        sourceX[j] = clampIndex(x0 - rx + j, image.cols) * cn + channel;
+    }
+    auto updateColumns = [&](int y, int delta) {
+        const uchar* row = image.ptr(clampIndex(y, image.rows));
+        for (int j = 0; j < columns; ++j) {
+            uchar v = row[sourceX[j]];
+            colCoarse[j * 16 + (v >> 4)] += delta;
+            colFine[j * 256 + v] += delta;
+        }
+    };
+    for (int y = -ry; y <= ry; ++y) {
+        updateColumns(y, 1);
+    }
+
+    uint32_t coarse[16];
+    uint32_t fine[16][16];
+    int lastUpdated[16];
+    for (int y = 0; y < image.rows; ++y) {
+        uchar* dst = result.ptr(y);
+        std::fill(coarse, coarse + 16, 0);
+        for (int j = 0; j < span; ++j) {
+            for (int b = 0; b < 16; ++b) {
+                coarse[b] += colCoarse[j * 16 + b];
+            }
+        }
+        std::fill(lastUpdated, lastUpdated + 16, -1);
+
+        for (int xi = 0; xi < x1 - x0; ++xi) {
+            // Window columns are [xi, xi + 2 * rx]
+            if (xi > 0) {
+                const uint16_t* added = &colCoarse[(xi + 2 * rx) * 16];
+                const uint16_t* removed = &colCoarse[(xi - 1) * 16];
+                for (int b = 0; b < 16; ++b) {
+                    coarse[b] += added[b] - removed[b];
+                }
+            }
+
+            uint32_t sum = 0;
+            int b = 0;
+            while (sum + coarse[b] <= rank) {
+                sum += coarse[b++];
+            }
+
+            uint32_t* level = fine[b];
+            if (lastUpdated[b] < 0 || xi - lastUpdated[b] > 2 * rx) {
+                std::fill(level, level + 16, 0);
+                for (int j = xi; j < xi + span; ++j) {
+                    const uint16_t* column = &colFine[j * 256 + b * 16];
+                    for (int k = 0; k < 16; ++k) {
+                        level[k] += column[k];
+                    }
+                }
+            } else {
+                for (int step = lastUpdated[b] + 1; step <= xi; ++step) {
+                    const uint16_t* added = &colFine[(step + 2 * rx) * 256 + b * 16];
+                    const uint16_t* removed = &colFine[(step - 1) * 256 + b * 16];
+                    for (int k = 0; k < 16; ++k) {
+                        level[k] += added[k] - removed[k];
+                    }
+                }
+            }
+            lastUpdated[b] = xi;
+
+            int k = 0;
+            while (sum + level[k] <= rank) {
+                sum += level[k++];
+            }
+            dst[(x0 + xi) * cn + channel] = static_cast<uchar>(b * 16 + k);
+        }
+
+        if (y + 1 < image.rows) {
+            updateColumns(y - ry, -1);
+            updateColumns(y + ry + 1, 1);
+        }
+    }
+}
+
+// 16-bit: per-column fine histograms of 65536 bins do not fit in cache, so the kernel
+// histogram slides horizontally (Huang), O(window height) per pixel, and the median is
+// found through a 256-bin coarse level
+void medianStrip16u(const cv::Mat& image, cv::Mat& result, int channel, int x0, int x1, int rx, int ry) {
+    const int cn = image.channels();
+    const uint32_t rank = static_cast<uint32_t>(2 * rx + 1) * (2 * ry + 1) / 2;
+    std::vector<uint32_t> fine(65536, 0);
+    uint32_t coarse[256] = {0};
+
+    auto updateColumn = [&](int y, int x, int delta) {
+        const int sx = clampIndex(x, image.cols) * cn + channel;
+        for (int dy = -ry; dy <= ry; ++dy) {
+            ushort v = image.ptr<ushort>(clampIndex(y + dy, image.rows))[sx];
+            fine[v] += delta;
+            coarse[v >> 8] += delta;
+        }
+    };
+
+    for (int y = 0; y < image.rows; ++y) {
+        ushort* dst = result.ptr<ushort>(y);
+        for (int x = x0 - rx; x <= x0 + rx; ++x) {
+            updateColumn(y, x, 1);
+        }
+        for (int x = x0; x < x1; ++x) {
+            if (x > x0) {
+                updateColumn(y, x - rx - 1, -1);
+                updateColumn(y, x + rx, 1);
+            }
+            uint32_t sum = 0;
+            int b = 0;
+            while (sum + coarse[b] <= rank) {
+                sum += coarse[b++];
+            }
+            int v = b * 256;
+            while (sum + fine[v] <= rank) {
+                sum += fine[v++];
+            }
+            dst[x * cn + channel] = static_cast<ushort>(v);
+        }
+        // Empty the histograms for the next row
+        for (int x = x1 - 1 - rx; x <= x1 - 1 + rx; ++x) {
+            updateColumn(y, x, -1);
+        }
+    }
+}
+
+} // namespace
+
+cv::Mat medianFilter(const cv::Mat& image, cv::Size kernelSize) {
+    if (kernelSize.width < 1 || kernelSize.height < 1 || kernelSize.width % 2 == 0 || kernelSize.height % 2 == 0) {
+        CV_Error(cv::Error::StsBadArg, "medianFilter: kernel sides must be odd and positive");
+    }
+    cv::Mat result;
+    // cv::medianBlur is fastest for small square windows
+    if (kernelSize.width == kernelSize.height && kernelSize.width <= 5) {
+        cv::medianBlur(image, result, kernelSize.width);
+        return result;
+    }
+    if (image.depth() != CV_8U && image.depth() != CV_16U) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "medianFilter: windows above 5x5 need CV_8U or CV_16U images");
+    }
+
+    result.create(image.size(), image.type());
+    const int rx = kernelSize.width / 2, ry = kernelSize.height / 2;
+    const int cn = image.channels();
+    const int strips = std::max(1, std::min(cv::getNumThreads(), image.cols / minStripWidth));
+    cv::parallel_for_(cv::Range(0, strips * cn), [&](const cv::Range& range) {
+        for (int task = range.start; task < range.end; ++task) {
+            const int s = task / cn, c = task % cn;
+            const int x0 = image.cols * s / strips, x1 = image.cols * (s + 1) / strips;
+            if (image.depth() == CV_8U) {
+                medianStrip8u(image, result, c, x0, x1, rx, ry);
+            } else {
+                medianStrip16u(image, result, c, x0, x1, rx, ry);
+            }
+        }
+    });
+    return result;
+}
+
+cv::Mat adaptiveMedianFilter(const cv::Mat& image, int maxKernelSize) {
+    if (maxKernelSize < 3 || maxKernelSize % 2 == 0) {
+        CV_Error(cv::Error::StsBadArg, "adaptiveMedianFilter: maxKernelSize must be odd and at least 3");
+    }
+    cv::Mat impulses;
+    cv::Mat result = image.clone();
+    switch (image.depth()) {
+        case CV_8U:
+            detectImpulses<uchar>(image, impulses);
+            replaceImpulses<uchar>(image, impulses, result, maxKernelSize);
+            break;
+        case CV_16U:
+            detectImpulses<ushort>(image, impulses);
+            replaceImpulses<ushort>(image, impulses, result, maxKernelSize);
+            break;
+        default:
+            CV_Error(cv::Error::StsUnsupportedFormat, "adaptiveMedianFilter: only CV_8U and CV_16U images are supported");
+    }
+    return result;
+}
+
+} // namespace semcv
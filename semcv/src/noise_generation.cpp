@@ -1,40 +1,328 @@
 #include "semcv.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <random>
+#include <vector>
 
 namespace semcv {
 
+namespace {
+
+// Poisson tables are at most 256 entries plus a 256-bucket guide per intensity (under 1 MB each)
+const size_t maxCachedPoissonTables = 16;
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+// The output is a pure function of (seed, counter), so any row block can be
+// generated independently and results do not depend on the thread count
+inline void philox4x32(uint64_t seed, uint64_t counter, uint32_t out[4]) {
+    uint32_t c0 = static_cast<uint32_t>(counter), c1 = static_cast<uint32_t>(counter >> 32), c2 = 0, c3 = 0;
+    uint32_t k0 = static_cast<uint32_t>(seed), k1 = static_cast<uint32_t>(seed >> 32);
+    for (int round = 0; round < 10; ++round) {
+        uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+        uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+        uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        c1 = static_cast<uint32_t>(p1);
+        c3 = static_cast<uint32_t>(p0);
+        c0 = n0;
+        c2 = n2;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+// 24 random bits mapped to [0, 1)
+inline float toUniform(uint32_t bits) {
+    return (bits >> 8) * (1.0f / 16777216.0f);
+}
+
+// 53 random bits mapped to [0, 1)
+inline double toUniform53(uint32_t high, uint32_t low) {
+    return ((high >> 5) * 67108864.0 + (low >> 6)) * (1.0 / 9007199254740992.0);
+}
+
+// Four standard normal variates from one Philox block (Box-Muller)
+inline void normals4(const uint32_t bits[4], float out[4]) {
+    const float twoPi = 6.28318530718f;
+    for (int i = 0; i < 4; i += 2) {
+        float u1 = toUniform(bits[i]) + 1.0f / 16777216.0f; // (0, 1], log stays finite
+        float u2 = toUniform(bits[i + 1]);
+        float r = std::sqrt(-2.0f * std::log(u1));
+        out[i] = r * std::cos(twoPi * u2);
+        out[i + 1] = r * std::sin(twoPi * u2);
+    }
+}
+
+// Four variates uniform in [-1, 1)
+inline void symmetricUniforms4(const uint32_t bits[4], float out[4]) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = 2.0f * toUniform(bits[i]) - 1.0f;
+    }
+}
+
+// Generate-and-add in one pass: sample i of the image (row-major, channels interleaved)
+// always receives variate i of the stream, the sum is saturated to the image depth
+template <typename T, typename V, typename Variates, typename Combine>
+void fuseNoise(const cv::Mat& image, cv::Mat& result, uint64_t seed, Variates variates, Combine combine) {
+    const int width = image.cols * image.channels();
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        std::vector<V> noise;
+        for (int y = range.start; y < range.end; ++y) {
+            const uint64_t first = static_cast<uint64_t>(y) * width;
+            const uint64_t firstBlock = first >> 2, lastBlock = (first + width + 3) >> 2;
+            noise.resize((lastBlock - firstBlock) * 4);
+            uint32_t bits[4];
+            for (uint64_t block = firstBlock; block < lastBlock; ++block) {
+                philox4x32(seed, block, bits);
+                variates(bits, noise.data() + (block - firstBlock) * 4);
+            }
+
+            const V* n = noise.data() + (first & 3);
+            const T* src = image.ptr<T>(y);
+            T* dst = result.ptr<T>(y);
+            for (int x = 0; x < width; ++x) {
+                dst[x] = cv::saturate_cast<T>(combine(src[x], n[x]));
+            }
+        }
+    });
+}
+
+template <typename Variates, typename Combine>
+cv::Mat addNoise(const cv::Mat& image, uint64_t seed, Variates variates, Combine combine) {
+    cv::Mat result(image.size(), image.type());
+    switch (image.depth()) {
+        case CV_8U:  fuseNoise<uchar, float>(image, result, seed, variates, combine); break;
+        case CV_16U: fuseNoise<ushort, float>(image, result, seed, variates, combine); break;
+        case CV_16S: fuseNoise<short, float>(image, result, seed, variates, combine); break;
+        case CV_32F: fuseNoise<float, float>(image, result, seed, variates, combine); break;
+        default:
+            CV_Error(cv::Error::StsUnsupportedFormat, "noise generation: only CV_8U, CV_16U, CV_16S and CV_32F images are supported");
+    }
+    return result;
+}
+
+// Inverse-CDF tables for Poisson noise on 8-bit images, one per intensity v with
+// lambda = v * scale. A 32-bit uniform u maps to the first entry with u < cdf; a guide
+// table indexed by the top 8 bits of u starts the scan next to the answer. Consecutive
+// counts with the same 8-bit output share one entry, so a table never exceeds 256 entries
+struct PoissonTables {
+    std::vector<uint64_t> cdf;     // scaled by 2^32, the last entry of every intensity is 2^32
+    std::vector<uchar> values;     // k / scale for the matching entry
+    std::vector<uint32_t> guide;   // 256 buckets per intensity, absolute entry index
+
+    uchar sample(uchar value, uint32_t u) const {
+        uint32_t index = guide[value * 256 + (u >> 24)];
+        while (u >= cdf[index]) {
+            ++index;
+        }
+        return values[index];
+    }
+};
+
+std::shared_ptr<const PoissonTables> buildPoissonTables(double scale) {
+    auto tables = std::make_shared<PoissonTables>();
+    tables->guide.resize(256 * 256);
+    for (int v = 0; v < 256; ++v) {
+        const double lambda = v * scale;
+        const size_t start = tables->cdf.size();
+        if (lambda <= 0) {
+            tables->cdf.push_back(uint64_t(1) << 32);
+            tables->values.push_back(0);
+        } else {
+            // Mass outside lambda +- 12 sigma is far below the 2^-32 resolution of u
+            const double spread = 12.0 * std::sqrt(lambda) + 12.0;
+            const int kMin = static_cast<int>(std::max(0.0, std::floor(lambda - spread)));
+            const int kMax = static_cast<int>(std::ceil(lambda + spread));
+            std::vector<double> pmf;
+            double total = 0.0;
+            for (int k = kMin; k <= kMax; ++k) {
+                pmf.push_back(std::exp(k * std::log(lambda) - lambda - std::lgamma(k + 1.0)));
+                total += pmf.back();
+            }
+            double cumulative = 0.0;
+            for (int k = kMin; k <= kMax; ++k) {
+                cumulative += pmf[k - kMin] / total;
+                uint64_t threshold = static_cast<uint64_t>(std::min(cumulative, 1.0) * 4294967296.0);
+                if (k == kMax) {
+                    threshold = uint64_t(1) << 32;
+                }
+                // Entries no u can select are dropped; a count with the same output as the
+                // previous entry extends it (outputs are nondecreasing in k)
+                const uchar value = cv::saturate_cast<uchar>(k / scale);
+                const bool hasEntry = tables->cdf.size() > start;
+                if (hasEntry && tables->values.back() == value) {
+                    tables->cdf.back() = std::max(tables->cdf.back(), threshold);
+                } else if (threshold > (hasEntry ? tables->cdf.back() : 0)) {
+                    tables->cdf.push_back(threshold);
+                    tables->values.push_back(value);
+                }
+            }
+        }
+        size_t index = start;
+        for (uint32_t bucket = 0; bucket < 256; ++bucket) {
+            while (tables->cdf[index] <= (uint64_t(bucket) << 24)) {
+                ++index;
+            }
+            tables->guide[v * 256 + bucket] = static_cast<uint32_t>(index);
+        }
+    }
+    return tables;
+}
+
+std::shared_ptr<const PoissonTables> getPoissonTables(double scale) {
+    static std::mutex cacheMutex;
+    static std::map<double, std::shared_ptr<const PoissonTables>> cache;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(scale);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    if (cache.size() >= maxCachedPoissonTables) {
+        cache.clear();
+    }
+    auto tables = buildPoissonTables(scale);
+    cache.emplace(scale, tables);
+    return tables;
+}
+
+// Seed for the overloads without one: follows cv::theRNG(), so cv::setRNGSeed still applies
+uint64_t nextSeed() {
+    cv::RNG& rng = cv::theRNG();
+    uint64_t high = rng.next();
+    return (high << 32) | rng.next();
+}
+
+} // namespace
+
 cv::Mat addGaussianNoise(const cv::Mat& image, double mean, double stddev) {
-    cv::Mat noise = cv::Mat::zeros(image.size(), image.type());
-    cv::randn(noise, cv::Scalar(mean), cv::Scalar(stddev));
+    return addGaussianNoise(image, mean, stddev, nextSeed());
+}
 
-    cv::Mat result;
-    cv::add(image, noise, result);
+cv::Mat addGaussianNoise(const cv::Mat& image, double mean, double stddev, uint64_t seed) {
+    const float m = static_cast<float>(mean), s = static_cast<float>(stddev);
+    return addNoise(image, seed, normals4, [m, s](float value, float z) { return value + m + s * z; });
+}
+
+cv::Mat addPoissonNoise(const cv::Mat& image, double scale) {
+    return addPoissonNoise(image, scale, nextSeed());
+}
+
+cv::Mat addPoissonNoise(const cv::Mat& image, double scale, uint64_t seed) {
+    if (scale <= 0) {
+        CV_Error(cv::Error::StsOutOfRange, "addPoissonNoise: scale must be positive");
+    }
+    cv::Mat result(image.size(), image.type());
+    if (image.depth() == CV_8U) {
+        std::shared_ptr<const PoissonTables> tables = getPoissonTables(scale);
+        auto bits4 = [](const uint32_t bits[4], uint32_t out[4]) {
+            for (int i = 0; i < 4; ++i) {
+                out[i] = bits[i];
+            }
+        };
+        fuseNoise<uchar, uint32_t>(image, result, seed, bits4,
+                                   [&tables](uchar value, uint32_t u) { return tables->sample(value, u); });
+        return result;
+    }
+
+    // Other depths: lambda is not limited to 256 values, sample per element with a
+    // row engine seeded from the counter-based stream
+    cv::Mat values;
+    image.convertTo(values, CV_64F);
+    const int width = image.cols * image.channels();
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            uint32_t bits[4];
+            philox4x32(seed, y, bits);
+            std::mt19937_64 engine((static_cast<uint64_t>(bits[0]) << 32) | bits[1]);
+            double* row = values.ptr<double>(y);
+            for (int x = 0; x < width; ++x) {
+                if (row[x] > 0) {
+                    std::poisson_distribution<long long> poisson(row[x] * scale);
+                    row[x] = poisson(engine) / scale;
+                }
+            }
+        }
+    });
+    values.convertTo(result, image.type());
     return result;
 }
 
 cv::Mat addSaltPepperNoise(const cv::Mat& image, double saltProb, double pepperProb) {
+    return addSaltPepperNoise(image, saltProb, pepperProb, nextSeed());
+}
+
+cv::Mat addSaltPepperNoise(const cv::Mat& image, double saltProb, double pepperProb, uint64_t seed) {
     cv::Mat result = image.clone();
-    cv::Mat noise = cv::Mat::zeros(image.size(), CV_8U);
-    cv::randu(noise, 0, 255);
+    applySaltPepperNoise(result, saltProb, pepperProb, seed);
+    return result;
+}
 
-    // Apply salt noise (white pixels)
-    cv::Mat saltMask = noise < (saltProb * 255);
-    result.setTo(cv::Scalar::all(255), saltMask);
+void applySaltPepperNoise(cv::Mat& image, double saltProb, double pepperProb, uint64_t seed) {
+    saltProb = std::max(saltProb, 0.0);
+    pepperProb = std::max(pepperProb, 0.0);
+    const double corruptProb = std::min(saltProb + pepperProb, 1.0);
+    if (image.empty() || corruptProb <= 0) {
+        return;
+    }
+    const double saltShare = saltProb / (saltProb + pepperProb);
+    const double logKeep = std::log1p(-corruptProb); // -inf when every pixel is corrupted
 
-    // Apply pepper noise (black pixels)
-    cv::Mat pepperMask = noise > ((1.0 - pepperProb) * 255);
-    result.setTo(cv::Scalar::all(0), pepperMask);
+    const cv::Mat salt(1, 1, image.type(), cv::Scalar::all(255));
+    const cv::Mat pepper = cv::Mat::zeros(1, 1, image.type());
+    const size_t pixelSize = image.elemSize();
 
-    return result;
+    // Pixels are split into fixed chunks with their own counter range, so the result
+    // depends only on the seed. Inside a chunk the gaps between corrupted pixels are
+    // geometric, and only corrupted pixels are visited
+    const int64_t pixels = static_cast<int64_t>(image.total());
+    const int64_t chunkSize = 1 << 16;
+    const int chunks = static_cast<int>((pixels + chunkSize - 1) / chunkSize);
+    cv::parallel_for_(cv::Range(0, chunks), [&](const cv::Range& range) {
+        for (int chunk = range.start; chunk < range.end; ++chunk) {
+            const int64_t end = std::min(pixels, (chunk + 1) * chunkSize);
+            int64_t position = static_cast<int64_t>(chunk) * chunkSize - 1;
+            for (uint32_t draw = 0;; ++draw) {
+                uint32_t bits[4];
+                philox4x32(seed, (static_cast<uint64_t>(chunk) << 32) | draw, bits);
+                double gap = logKeep < -1e300 ? 0.0 : std::floor(std::log1p(-toUniform53(bits[0], bits[1])) / logKeep);
+                if (gap >= static_cast<double>(end - position - 1)) {
+                    break;
+                }
+                position += static_cast<int64_t>(gap) + 1;
+
+                const bool isSalt = toUniform53(bits[2], bits[3]) < saltShare;
+                uchar* pixel = image.ptr(static_cast<int>(position / image.cols)) + (position % image.cols) * pixelSize;
+                std::memcpy(pixel, isSalt ? salt.data : pepper.data, pixelSize);
+            }
+        }
+    });
 }
 
 cv::Mat addUniformNoise(const cv::Mat& image, double amplitude) {
-    cv::Mat noise = cv::Mat::zeros(image.size(), image.type());
-    cv::randu(noise, cv::Scalar(-amplitude), cv::Scalar(amplitude));
+    return addUniformNoise(image, amplitude, nextSeed());
+}
 
-    cv::Mat result;
-    cv::add(image, noise, result);
-    return result;
+cv::Mat addUniformNoise(const cv::Mat& image, double amplitude, uint64_t seed) {
+    const float a = static_cast<float>(amplitude);
+    return addNoise(image, seed, symmetricUniforms4, [a](float value, float u) { return value + a * u; });
+}
+
+cv::Mat addSpeckleNoise(const cv::Mat& image, double variance) {
+    return addSpeckleNoise(image, variance, nextSeed());
+}
+
+cv::Mat addSpeckleNoise(const cv::Mat& image, double variance, uint64_t seed) {
+    const float s = static_cast<float>(std::sqrt(variance));
+    return addNoise(image, seed, normals4, [s](float value, float z) { return value + value * s * z; });
 }
 
 } // namespace semcv
@@ -0,0 +1,56 @@
+#include "semcv.h"
+
+namespace semcv {
+
+// Every operation is applied to the current 1x256 table with the same OpenCV call the
+// standalone function uses, so the composed table reproduces the chain bit for bit
+
+PointOps::PointOps() : lookupTable(1, 256, CV_8U) {
+    uchar* p = lookupTable.ptr();
+    for (int i = 0; i < 256; ++i) {
+        p[i] = static_cast<uchar>(i);
+    }
+}
+
+PointOps& PointOps::gamma(double gamma) {
+    cv::LUT(lookupTable, getGammaLUT(gamma, CV_8U), lookupTable);
+    return *this;
+}
+
+PointOps& PointOps::linear(double alpha, double beta) {
+    lookupTable.convertTo(lookupTable, -1, alpha, beta);
+    return *this;
+}
+
+PointOps& PointOps::autoContrast(const cv::Mat& reference, double clipPercent) {
+    double alpha, beta;
+    autoContrastCoefficients(reference, clipPercent, alpha, beta);
+    return linear(alpha, beta);
+}
+
+PointOps& PointOps::threshold(double threshold, int maxval, int type) {
+    if ((type & ~cv::THRESH_MASK) != 0) {
+        CV_Error(cv::Error::StsBadFlag, "PointOps::threshold: automatic thresholds (OTSU/TRIANGLE) depend on the image");
+    }
+    cv::threshold(lookupTable, lookupTable, threshold, maxval, type);
+    return *this;
+}
+
+PointOps& PointOps::lut(const cv::Mat& table) {
+    if (table.total() != 256 || table.type() != CV_8UC1) {
+        CV_Error(cv::Error::StsBadArg, "PointOps::lut: expected a 256-entry CV_8UC1 table");
+    }
+    cv::LUT(lookupTable, table, lookupTable);
+    return *this;
+}
+
+cv::Mat PointOps::apply(const cv::Mat& image) const {
+    if (image.depth() != CV_8U) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "PointOps::apply: only CV_8U images are supported");
+    }
+    cv::Mat result;
+    cv::LUT(image, lookupTable, result);
+    return result;
+}
+
+} // namespace semcv
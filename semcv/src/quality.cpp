@@ -0,0 +1,243 @@
+#include "semcv.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+namespace semcv {
+
+namespace {
+
+// Per-channel sums gathered in the single pass; d = candidate - reference
+struct Moments {
+    double sumSignal[4] = {0, 0, 0, 0};
+    double sumSignal2[4] = {0, 0, 0, 0};
+    double sumDiff[4] = {0, 0, 0, 0};
+    double sumDiff2[4] = {0, 0, 0, 0};
+    double sumAbsDiff[4] = {0, 0, 0, 0};
+    double maxError = 0;
+
+    void add(const Moments& other) {
+        for (int c = 0; c < 4; ++c) {
+            sumSignal[c] += other.sumSignal[c];
+            sumSignal2[c] += other.sumSignal2[c];
+            sumDiff[c] += other.sumDiff[c];
+            sumDiff2[c] += other.sumDiff2[c];
+            sumAbsDiff[c] += other.sumAbsDiff[c];
+        }
+        maxError = std::max(maxError, other.maxError);
+    }
+};
+
+// Integer images are accumulated exactly in 64-bit integers per row, then flushed
+template <typename T>
+void accumulateRow(const T* reference, const T* candidate, int cols, int cn, Moments& moments) {
+    using Acc = typename std::conditional<std::is_integral<T>::value, int64_t, double>::type;
+    Acc signal[4] = {0, 0, 0, 0}, signal2[4] = {0, 0, 0, 0};
+    Acc diff[4] = {0, 0, 0, 0}, diff2[4] = {0, 0, 0, 0}, absDiff[4] = {0, 0, 0, 0};
+    Acc maxError = 0;
+    for (int x = 0, i = 0; x < cols; ++x) {
+        for (int c = 0; c < cn; ++c, ++i) {
+            Acc r = reference[i];
+            Acc d = static_cast<Acc>(candidate[i]) - r;
+            Acc a = d < 0 ? -d : d;
+            signal[c] += r;
+            signal2[c] += r * r;
+            diff[c] += d;
+            diff2[c] += d * d;
+            absDiff[c] += a;
+            maxError = std::max(maxError, a);
+        }
+    }
+    for (int c = 0; c < cn; ++c) {
+        moments.sumSignal[c] += static_cast<double>(signal[c]);
+        moments.sumSignal2[c] += static_cast<double>(signal2[c]);
+        moments.sumDiff[c] += static_cast<double>(diff[c]);
+        moments.sumDiff2[c] += static_cast<double>(diff2[c]);
+        moments.sumAbsDiff[c] += static_cast<double>(absDiff[c]);
+    }
+    moments.maxError = std::max(moments.maxError, static_cast<double>(maxError));
+}
+
+// Reads every reference row once and compares it against all candidates while it is in cache
+template <typename T>
+std::vector<Moments> accumulateBatch(const cv::Mat& reference, const std::vector<cv::Mat>& candidates) {
+    const int stripes = std::max(1, std::min(reference.rows, cv::getNumThreads()));
+    std::vector<std::vector<Moments>> partials(stripes, std::vector<Moments>(candidates.size()));
+    cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s) {
+            for (int y = reference.rows * s / stripes; y < reference.rows * (s + 1) / stripes; ++y) {
+                const T* ref = reference.ptr<T>(y);
+                for (size_t k = 0; k < candidates.size(); ++k) {
+                    accumulateRow(ref, candidates[k].ptr<T>(y), reference.cols, reference.channels(), partials[s][k]);
+                }
+            }
+        }
+    });
+    std::vector<Moments> result(candidates.size());
+    for (const auto& partial : partials) {
+        for (size_t k = 0; k < candidates.size(); ++k) {
+            result[k].add(partial[k]);
+        }
+    }
+    return result;
+}
+
+QualityStats finishStats(const Moments& moments, int cn, double count, double maxValue) {
+    QualityStats stats;
+    stats.channels = cn;
+    stats.maxError = moments.maxError;
+    double totalSSE = 0.0;
+    for (int c = 0; c < cn; ++c) {
+        stats.sse[c] = moments.sumDiff2[c];
+        stats.mse[c] = moments.sumDiff2[c] / count;
+        stats.psnr[c] = stats.mse[c] == 0 ? std::numeric_limits<double>::infinity()
+                                          : 10.0 * std::log10(maxValue * maxValue / stats.mse[c]);
+        stats.signalMean[c] = moments.sumSignal[c] / count;
+        stats.signalStddev[c] = std::sqrt(std::max(moments.sumSignal2[c] / count - stats.signalMean[c] * stats.signalMean[c], 0.0));
+        stats.noiseMean[c] = moments.sumDiff[c] / count;
+        stats.noiseStddev[c] = std::sqrt(std::max(stats.mse[c] - stats.noiseMean[c] * stats.noiseMean[c], 0.0));
+        stats.absNoiseMean[c] = moments.sumAbsDiff[c] / count;
+        stats.snr[c] = 20.0 * std::log10(stats.signalMean[c] / stats.noiseStddev[c]);
+        totalSSE += moments.sumDiff2[c];
+    }
+    stats.mseAll = totalSSE / (count * cn);
+    stats.psnrAll = stats.mseAll == 0 ? std::numeric_limits<double>::infinity()
+                                      : 10.0 * std::log10(maxValue * maxValue / stats.mseAll);
+    return stats;
+}
+
+// Running window sums of x, y, x^2, y^2 and xy for one channel: column sums are updated
+// incrementally as the window moves down, row sums as it moves right
+template <typename T>
+double ssimStripe(const cv::Mat& reference, const cv::Mat& candidate, int channel, int window,
+                  int firstRow, int lastRow, double c1, double c2) {
+    const int cols = reference.cols, cn = reference.channels();
+    const double area = static_cast<double>(window) * window;
+    std::vector<double> columns(5 * static_cast<size_t>(cols), 0.0);
+    double* sx = columns.data();
+    double* sy = sx + cols;
+    double* sxx = sy + cols;
+    double* syy = sxx + cols;
+    double* sxy = syy + cols;
+
+    auto addRow = [&](int y, double sign) {
+        const T* r = reference.ptr<T>(y) + channel;
+        const T* q = candidate.ptr<T>(y) + channel;
+        for (int x = 0; x < cols; ++x) {
+            double a = r[x * cn], b = q[x * cn];
+            sx[x] += sign * a;
+            sy[x] += sign * b;
+            sxx[x] += sign * a * a;
+            syy[x] += sign * b * b;
+            sxy[x] += sign * a * b;
+        }
+    };
+
+    // Window rows [y - window + 1, y] for every output row y in [firstRow, lastRow)
+    for (int y = firstRow - window + 1; y < firstRow; ++y) {
+        addRow(y, 1.0);
+    }
+    double total = 0.0;
+    for (int y = firstRow; y < lastRow; ++y) {
+        addRow(y, 1.0);
+        double w[5] = {0, 0, 0, 0, 0};
+        for (int x = 0; x < cols; ++x) {
+            w[0] += sx[x];
+            w[1] += sy[x];
+            w[2] += sxx[x];
+            w[3] += syy[x];
+            w[4] += sxy[x];
+            if (x >= window) {
+                w[0] -= sx[x - window];
+                w[1] -= sy[x - window];
+                w[2] -= sxx[x - window];
+                w[3] -= syy[x - window];
+                w[4] -= sxy[x - window];
+            }
+            if (x >= window - 1) {
+                double mx = w[0] / area, my = w[1] / area;
+                double vx = w[2] / area - mx * mx, vy = w[3] / area - my * my, cxy = w[4] / area - mx * my;
+                total += ((2 * mx * my + c1) * (2 * cxy + c2)) / ((mx * mx + my * my + c1) * (vx + vy + c2));
+            }
+        }
+        addRow(y - window + 1, -1.0);
+    }
+    return total;
+}
+
+void checkPair(const cv::Mat& reference, const cv::Mat& candidate) {
+    if (reference.size() != candidate.size() || reference.type() != candidate.type()) {
+        CV_Error(cv::Error::StsUnmatchedSizes, "quality: reference and candidate must have the same size and type");
+    }
+}
+
+} // namespace
+
+QualityStats computeQuality(const cv::Mat& reference, const cv::Mat& candidate, double maxValue) {
+    return computeQuality(reference, std::vector<cv::Mat>{candidate}, maxValue).front();
+}
+
+std::vector<QualityStats> computeQuality(const cv::Mat& reference, const std::vector<cv::Mat>& candidates, double maxValue) {
+    for (const auto& candidate : candidates) {
+        checkPair(reference, candidate);
+    }
+    if (reference.channels() > 4) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "quality: at most 4 channels are supported");
+    }
+
+    std::vector<Moments> moments;
+    switch (reference.depth()) {
+        case CV_8U:  moments = accumulateBatch<uchar>(reference, candidates); break;
+        case CV_16U: moments = accumulateBatch<ushort>(reference, candidates); break;
+        case CV_16S: moments = accumulateBatch<short>(reference, candidates); break;
+        case CV_32F: moments = accumulateBatch<float>(reference, candidates); break;
+        default:
+            CV_Error(cv::Error::StsUnsupportedFormat, "quality: only CV_8U, CV_16U, CV_16S and CV_32F images are supported");
+    }
+
+    std::vector<QualityStats> result;
+    for (const auto& m : moments) {
+        result.push_back(finishStats(m, reference.channels(), static_cast<double>(reference.total()), maxValue));
+    }
+    return result;
+}
+
+cv::Scalar computeSSIM(const cv::Mat& reference, const cv::Mat& candidate, int window, double maxValue) {
+    checkPair(reference, candidate);
+    if (reference.depth() != CV_8U && reference.depth() != CV_16U && reference.depth() != CV_32F) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "computeSSIM: only CV_8U, CV_16U and CV_32F images are supported");
+    }
+    if (window < 1 || reference.rows < window || reference.cols < window || reference.channels() > 4) {
+        CV_Error(cv::Error::StsBadSize, "computeSSIM: image must be at least one window in size and have at most 4 channels");
+    }
+    const double c1 = (0.01 * maxValue) * (0.01 * maxValue);
+    const double c2 = (0.03 * maxValue) * (0.03 * maxValue);
+
+    // Output rows are split into stripes; each stripe primes its column sums from the rows above it
+    const int outputRows = reference.rows - window + 1;
+    const int stripes = std::max(1, std::min(outputRows, cv::getNumThreads()));
+    const int cn = reference.channels();
+    std::vector<double> totals(static_cast<size_t>(stripes) * cn, 0.0);
+    cv::parallel_for_(cv::Range(0, stripes * cn), [&](const cv::Range& range) {
+        for (int task = range.start; task < range.end; ++task) {
+            int s = task / cn, c = task % cn;
+            int firstRow = window - 1 + outputRows * s / stripes;
+            int lastRow = window - 1 + outputRows * (s + 1) / stripes;
+            switch (reference.depth()) {
+                case CV_8U:  totals[task] = ssimStripe<uchar>(reference, candidate, c, window, firstRow, lastRow, c1, c2); break;
+                case CV_16U: totals[task] = ssimStripe<ushort>(reference, candidate, c, window, firstRow, lastRow, c1, c2); break;
+                default:     totals[task] = ssimStripe<float>(reference, candidate, c, window, firstRow, lastRow, c1, c2); break;
+            }
+        }
+    });
+
+    cv::Scalar result;
+    const double positions = static_cast<double>(outputRows) * (reference.cols - window + 1);
+    for (int task = 0; task < stripes * cn; ++task) {
+        result[task % cn] += totals[task] / positions;
+    }
+    return result;
+}
+
+} // namespace semcv
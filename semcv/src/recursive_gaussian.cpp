@@ -0,0 +1,239 @@
+#include "semcv.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace semcv {
+
+namespace {
+
+// Interleaved floats per column block in the vertical pass
+const int columnBlock = 64;
+// Reflected samples added per side for BORDER_REFLECT_101, in sigmas; past them the border is
+// replicated, which costs less than the Young-van Vliet approximation error itself
+const double reflectPadSigmas = 4.0;
+
+// Young-van Vliet third-order recursion v[n] = B x[n] + a1 v[n-1] + a2 v[n-2] + a3 v[n-3],
+// run forward then backward. M maps the last three forward outputs (minus the steady state)
+// to the backward state past the end, which makes a replicated border exact (Triggs-Sdika)
+struct YvvCoefficients {
+    float B, a1, a2, a3;
+    float M[3][3];
+};
+
+YvvCoefficients yvvCoefficients(double sigma) {
+    const double q = sigma >= 2.5 ? 0.98711 * sigma - 0.96330 : 3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+    const double b0 = 1.57825 + 2.44413 * q + 1.4281 * q * q + 0.422205 * q * q * q;
+    const double a1 = (2.44413 * q + 2.85619 * q * q + 1.26661 * q * q * q) / b0;
+    const double a2 = -(1.4281 * q * q + 1.26661 * q * q * q) / b0;
+    const double a3 = 0.422205 * q * q * q / b0;
+    const double B = 1.0 - (a1 + a2 + a3);
+
+    YvvCoefficients c;
+    c.B = static_cast<float>(B);
+    c.a1 = static_cast<float>(a1);
+    c.a2 = static_cast<float>(a2);
+    c.a3 = static_cast<float>(a3);
+
+    // M column j: response to a unit deviation of forward output N-1-j on a constant tail,
+    // obtained by running both recursions until the response has decayed
+    const int tail = static_cast<int>(40 * sigma) + 50;
+    std::vector<double> u(tail + 3), v(tail + 6);
+    for (int j = 0; j < 3; ++j) {
+        std::fill(u.begin(), u.end(), 0.0);
+        std::fill(v.begin(), v.end(), 0.0);
+        u[2 - j] = 1.0;
+        for (int k = 3; k < tail + 3; ++k) {
+            u[k] = a1 * u[k - 1] + a2 * u[k - 2] + a3 * u[k - 3];
+        }
+        for (int k = tail + 2; k >= 2; --k) {
+            v[k] = B * u[k] + a1 * v[k + 1] + a2 * v[k + 2] + a3 * v[k + 3];
+        }
+        for (int r = 0; r < 3; ++r) {
+            c.M[r][j] = static_cast<float>(v[2 + r]);
+        }
+    }
+    return c;
+}
+
+// In place along one line of n samples spaced `step` floats apart
+void yvvLine(float* p, int n, int step, const YvvCoefficients& c) {
+    const float first = p[0], last = p[static_cast<size_t>(n - 1) * step];
+    float s1 = first, s2 = first, s3 = first;
+    for (int k = 0; k < n; ++k) {
+        float& x = p[static_cast<size_t>(k) * step];
+        const float v = c.B * x + c.a1 * s1 + c.a2 * s2 + c.a3 * s3;
+        s3 = s2;
+        s2 = s1;
+        s1 = v;
+        x = v;
+    }
+    const float d0 = s1 - last, d1 = s2 - last, d2 = s3 - last;
+    s1 = c.M[0][0] * d0 + c.M[0][1] * d1 + c.M[0][2] * d2 + last;
+    s2 = c.M[1][0] * d0 + c.M[1][1] * d1 + c.M[1][2] * d2 + last;
+    s3 = c.M[2][0] * d0 + c.M[2][1] * d1 + c.M[2][2] * d2 + last;
+    p[static_cast<size_t>(n - 1) * step] = s1;
+    for (int k = n - 2; k >= 0; --k) {
+        float& x = p[static_cast<size_t>(k) * step];
+        const float v = c.B * x + c.a1 * s1 + c.a2 * s2 + c.a3 * s3;
+        s3 = s2;
+        s2 = s1;
+        s1 = v;
+        x = v;
+    }
+}
+
+// Source index of every position of a line of n samples padded by `pad` on each side
+std::vector<int> reflectedIndices(int n, int pad) {
+    std::vector<int> indices(n + 2 * pad);
+    for (int i = 0; i < n + 2 * pad; ++i) {
+        indices[i] = cv::borderInterpolate(i - pad, n, cv::BORDER_REFLECT_101);
+    }
+    return indices;
+}
+
+// Rows in parallel, one line per channel. With pad > 0 each line is run on a reflected copy
+void horizontalPass(cv::Mat& data, int cn, int pad, const YvvCoefficients& c) {
+    const int cols = data.cols / cn;
+    const std::vector<int> source = reflectedIndices(cols, pad);
+    cv::parallel_for_(cv::Range(0, data.rows), [&](const cv::Range& range) {
+        std::vector<float> line(source.size());
+        for (int y = range.start; y < range.end; ++y) {
+            float* row = data.ptr<float>(y);
+            for (int ch = 0; ch < cn; ++ch) {
+                if (pad == 0) {
+                    yvvLine(row + ch, cols, cn, c);
+                    continue;
+                }
+                for (size_t i = 0; i < source.size(); ++i) {
+                    line[i] = row[source[i] * cn + ch];
+                }
+                yvvLine(line.data(), static_cast<int>(line.size()), 1, c);
+                for (int x = 0; x < cols; ++x) {
+                    row[x * cn + ch] = line[x + pad];
+                }
+            }
+        }
+    });
+}
+
+// n <= columnBlock adjacent columns starting at p, rows `step` floats apart, walked down together
+void yvvColumns(float* p, int rows, size_t step, int n, const YvvCoefficients& c) {
+    float s1[columnBlock], s2[columnBlock], s3[columnBlock], last[columnBlock];
+    const float* bottom = p + static_cast<size_t>(rows - 1) * step;
+    for (int i = 0; i < n; ++i) {
+        s1[i] = s2[i] = s3[i] = p[i];
+        last[i] = bottom[i];
+    }
+    for (int y = 0; y < rows; ++y) {
+        float* row = p + static_cast<size_t>(y) * step;
+        for (int i = 0; i < n; ++i) {
+            const float v = c.B * row[i] + c.a1 * s1[i] + c.a2 * s2[i] + c.a3 * s3[i];
+            s3[i] = s2[i];
+            s2[i] = s1[i];
+            s1[i] = v;
+            row[i] = v;
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        const float d0 = s1[i] - last[i], d1 = s2[i] - last[i], d2 = s3[i] - last[i];
+        s1[i] = c.M[0][0] * d0 + c.M[0][1] * d1 + c.M[0][2] * d2 + last[i];
+        s2[i] = c.M[1][0] * d0 + c.M[1][1] * d1 + c.M[1][2] * d2 + last[i];
+        s3[i] = c.M[2][0] * d0 + c.M[2][1] * d1 + c.M[2][2] * d2 + last[i];
+    }
+    std::copy(s1, s1 + n, p + static_cast<size_t>(rows - 1) * step);
+    for (int y = rows - 2; y >= 0; --y) {
+        float* row = p + static_cast<size_t>(y) * step;
+        for (int i = 0; i < n; ++i) {
+            const float v = c.B * row[i] + c.a1 * s1[i] + c.a2 * s2[i] + c.a3 * s3[i];
+            s3[i] = s2[i];
+            s2[i] = s1[i];
+            s1[i] = v;
+            row[i] = v;
+        }
+    }
+}
+
+// Blocks of adjacent columns walk down the image together, so every row access is a
+// contiguous run and the recursion state for the block stays in registers or L1. With
+// pad > 0 the block is gathered into a reflected buffer first
+void verticalPass(cv::Mat& data, int pad, const YvvCoefficients& c) {
+    const int rows = data.rows, width = data.cols;
+    const int blocks = (width + columnBlock - 1) / columnBlock;
+    const std::vector<int> source = reflectedIndices(rows, pad);
+    cv::parallel_for_(cv::Range(0, blocks), [&](const cv::Range& range) {
+        std::vector<float> buffer(pad > 0 ? source.size() * columnBlock : 0);
+        for (int b = range.start; b < range.end; ++b) {
+            const int x0 = b * columnBlock, n = std::min(columnBlock, width - x0);
+            if (pad == 0) {
+                yvvColumns(data.ptr<float>(0) + x0, rows, data.step1(), n, c);
+                continue;
+            }
+            for (size_t i = 0; i < source.size(); ++i) {
+                const float* row = data.ptr<float>(source[i]) + x0;
+                std::copy(row, row + n, &buffer[i * columnBlock]);
+            }
+            yvvColumns(buffer.data(), static_cast<int>(source.size()), columnBlock, n, c);
+            for (int y = 0; y < rows; ++y) {
+                const float* row = &buffer[static_cast<size_t>(y + pad) * columnBlock];
+                std::copy(row, row + n, data.ptr<float>(y) + x0);
+            }
+        }
+    });
+}
+
+double elapsedMs(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+cv::Mat recursiveGaussianFilter(const cv::Mat& image, double sigmaX, double sigmaY, int borderType) {
+    if (sigmaY <= 0) sigmaY = sigmaX;
+    if (borderType != cv::BORDER_REPLICATE && borderType != cv::BORDER_REFLECT_101) {
+        CV_Error(cv::Error::StsBadArg, "recursiveGaussianFilter: only BORDER_REPLICATE and BORDER_REFLECT_101 are supported");
+    }
+    if (sigmaX < 0.5 || sigmaY < 0.5) {
+        CV_Error(cv::Error::StsOutOfRange, "recursiveGaussianFilter: sigma must be at least 0.5");
+    }
+    if (image.channels() > 4) {
+        CV_Error(cv::Error::StsUnsupportedFormat, "recursiveGaussianFilter: at most 4 channels are supported");
+    }
+
+    // Work on a single-channel view of the interleaved float data
+    const int cn = image.channels();
+    cv::Mat data;
+    image.convertTo(data, CV_32F);
+    data = data.reshape(1);
+    const bool reflect = borderType == cv::BORDER_REFLECT_101;
+    const int padX = reflect ? static_cast<int>(std::ceil(reflectPadSigmas * sigmaX)) : 0;
+    const int padY = reflect ? static_cast<int>(std::ceil(reflectPadSigmas * sigmaY)) : 0;
+    horizontalPass(data, cn, padX, yvvCoefficients(sigmaX));
+    verticalPass(data, padY, yvvCoefficients(sigmaY));
+
+    cv::Mat result;
+    data.reshape(cn).convertTo(result, image.depth());
+    return result;
+}
+
+std::vector<GaussianTiming> benchmarkGaussianFilters(const cv::Mat& image, const std::vector<double>& sigmas, int repeats) {
+    std::vector<GaussianTiming> timings;
+    for (double sigma : sigmas) {
+        GaussianTiming timing;
+        timing.sigma = sigma;
+        const int ksize = 2 * static_cast<int>(std::ceil(3 * sigma)) + 1;
+        cv::Mat fir, iir;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            cv::GaussianBlur(image, fir, cv::Size(ksize, ksize), sigma, sigma, cv::BORDER_REPLICATE);
+            timing.firMs += elapsedMs(start) / repeats;
+            start = std::chrono::steady_clock::now();
+            iir = recursiveGaussianFilter(image, sigma, sigma);
+            timing.iirMs += elapsedMs(start) / repeats;
+        }
+        timings.push_back(timing);
+    }
+    return timings;
+}
+
+} // namespace semcv
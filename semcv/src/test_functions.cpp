@@ -1,4 +1,6 @@
 #include "semcv.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace semcv {
@@ -9,10 +11,29 @@ bool runTests() {
     bool allPassed = true;
 
     allPassed &= testGammaCorrection();
+    allPassed &= testGammaLUTCache();
+    allPassed &= testGammaCorrectionMulti();
     allPassed &= testNoiseGeneration();
+    allPassed &= testNoiseDeterminism();
+    allPassed &= testPoissonNoise();
+    allPassed &= testSaltPepperNoise();
     allPassed &= testAutoContrast();
+    allPassed &= testPointOps();
+    allPassed &= testTemporalAutoContrast();
+    allPassed &= testClaheEngine();
+    allPassed &= testColorEqualization();
+    allPassed &= testHistogram();
+    allPassed &= testQualityMetrics();
     allPassed &= testBinarization();
+    allPassed &= testIntegralImage();
+    allPassed &= testStreamingBinarization();
+    allPassed &= testMultiOtsu();
     allPassed &= testLinearFiltering();
+    allPassed &= testAdaptiveMedian();
+    allPassed &= testLargeMedian();
+    allPassed &= testBilateralGrid();
+    allPassed &= testRecursiveGaussian();
+    allPassed &= testCustomLinearFilter();
     allPassed &= testObjectDetection();
     allPassed &= testEdgeDetection();
 
@@ -42,6 +63,82 @@ bool testGammaCorrection() {
     return true;
 }
 
+bool testGammaLUTCache() {
+    std::cout << "Testing gamma LUT cache and high bit depth gamma..." << std::endl;
+
+    // Cached table is reused between calls
+    cv::Mat lut1 = getGammaLUT(2.2, CV_8U);
+    cv::Mat lut2 = getGammaLUT(2.2, CV_8U);
+    bool shared = lut1.data == lut2.data;
+
+    // 16-bit path matches the exact formula
+    cv::Mat image16(64, 64, CV_16UC1);
+    for (int i = 0; i < image16.rows; ++i) {
+        for (int j = 0; j < image16.cols; ++j) {
+            image16.at<ushort>(i, j) = static_cast<ushort>((i * 64 + j) * 16);
+        }
+    }
+    cv::Mat result16 = gammaCorrection(image16, 2.2);
+    bool exact16 = result16.type() == CV_16UC1;
+    for (int i = 0; i < image16.rows && exact16; ++i) {
+        for (int j = 0; j < image16.cols; ++j) {
+            ushort expected = cv::saturate_cast<ushort>(std::pow(image16.at<ushort>(i, j) / 65535.0, 1.0 / 2.2) * 65535.0);
+            if (result16.at<ushort>(i, j) != expected) {
+                exact16 = false;
+                break;
+            }
+        }
+    }
+
+    // 32-bit float path stays within the documented error bound
+    cv::Mat image32(64, 64, CV_32FC3);
+    cv::randu(image32, cv::Scalar::all(0.0), cv::Scalar::all(4.0));
+    cv::Mat result32 = gammaCorrection(image32, 2.2);
+    double maxError = 0.0;
+    for (int i = 0; i < image32.rows; ++i) {
+        const float* src = image32.ptr<float>(i);
+        const float* dst = result32.ptr<float>(i);
+        for (int j = 0; j < image32.cols * 3; ++j) {
+            double expected = std::pow(static_cast<double>(src[j]), 1.0 / 2.2);
+            if (expected > 0) {
+                maxError = std::max(maxError, std::abs(dst[j] - expected) / expected);
+            }
+        }
+    }
+
+    std::cout << "Max relative error (CV_32F): " << maxError << std::endl;
+    if (shared && exact16 && maxError < 1e-5) {
+        std::cout << "Gamma LUT cache test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Gamma LUT cache test FAILED." << std::endl;
+    return false;
+}
+
+bool testGammaCorrectionMulti() {
+    std::cout << "Testing multi-gamma correction..." << std::endl;
+
+    cv::Mat testImage(60, 80, CV_8UC3);
+    cv::randu(testImage, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    std::vector<double> gammas = {0.5, 1.0, 2.2, 3.0};
+    std::vector<cv::Mat> results = gammaCorrectionMulti(testImage, gammas);
+
+    // Every output must match the single-gamma path exactly
+    bool identical = results.size() == gammas.size();
+    for (size_t i = 0; i < results.size() && identical; ++i) {
+        cv::Mat expected = gammaCorrection(testImage, gammas[i]);
+        identical = results[i].type() == testImage.type() && cv::norm(results[i], expected, cv::NORM_INF) == 0;
+    }
+
+    if (identical) {
+        std::cout << "Multi-gamma correction test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Multi-gamma correction test FAILED." << std::endl;
+    return false;
+}
+
 bool testNoiseGeneration() {
     std::cout << "Testing noise generation..." << std::endl;
 
@@ -55,6 +152,112 @@ bool testNoiseGeneration() {
     return true;
 }
 
+bool testNoiseDeterminism() {
+    std::cout << "Testing noise determinism and bias..." << std::endl;
+
+    cv::Mat testImage = cv::Mat::ones(257, 131, CV_8UC3) * 128;
+
+    // Same seed gives the same noise for any number of threads
+    int threads = cv::getNumThreads();
+    cv::setNumThreads(1);
+    cv::Mat single = addGaussianNoise(testImage, 0, 25, 42);
+    cv::setNumThreads(threads);
+    cv::Mat parallel = addGaussianNoise(testImage, 0, 25, 42);
+    bool deterministic = cv::norm(single, parallel, cv::NORM_INF) == 0 &&
+                         cv::norm(addSpeckleNoise(testImage, 0.1, 7), addSpeckleNoise(testImage, 0.1, 7), cv::NORM_INF) == 0;
+    bool seedMatters = cv::norm(addUniformNoise(testImage, 50, 1), addUniformNoise(testImage, 50, 2), cv::NORM_INF) > 0;
+
+    // Signed noise on 8-bit data is not biased
+    cv::Mat signedNoise;
+    parallel.convertTo(signedNoise, CV_32F);
+    signedNoise -= cv::Scalar::all(128);
+    cv::Scalar mean, stddev;
+    cv::meanStdDev(signedNoise.reshape(1), mean, stddev);
+    bool unbiased = std::abs(mean[0]) < 1.0 && std::abs(stddev[0] - 25) < 1.0;
+
+    std::cout << "Noise mean: " << mean[0] << ", std dev: " << stddev[0] << std::endl;
+    if (deterministic && seedMatters && unbiased) {
+        std::cout << "Noise determinism test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Noise determinism test FAILED." << std::endl;
+    return false;
+}
+
+bool testPoissonNoise() {
+    std::cout << "Testing Poisson noise..." << std::endl;
+
+    cv::Mat testImage(200, 200, CV_8UC1);
+    testImage(cv::Rect(0, 0, 100, 200)).setTo(20);
+    testImage(cv::Rect(100, 0, 100, 200)).setTo(100);
+
+    // Mean follows the intensity, variance is intensity / scale
+    auto moments = [](const cv::Mat& noisy, const cv::Rect& area, double& mean, double& variance) {
+        cv::Scalar m, s;
+        cv::meanStdDev(noisy(area), m, s);
+        mean = m[0];
+        variance = s[0] * s[0];
+    };
+    cv::Rect dark(0, 0, 100, 200), bright(100, 0, 100, 200);
+    double mean, variance, mean4, variance4;
+    cv::Mat noisy = addPoissonNoise(testImage, 1.0, 5);
+    moments(noisy, bright, mean, variance);
+    cv::Mat noisy4 = addPoissonNoise(testImage, 4.0, 5);
+    moments(noisy4, bright, mean4, variance4);
+    double darkMean, darkVariance;
+    moments(noisy, dark, darkMean, darkVariance);
+
+    bool statsOk = std::abs(mean - 100) < 1.0 && std::abs(variance - 100) < 10 &&
+                   std::abs(mean4 - 100) < 1.0 && std::abs(variance4 - 25) < 5 &&
+                   std::abs(darkMean - 20) < 0.5 && std::abs(darkVariance - 20) < 3;
+    bool deterministic = cv::norm(noisy, addPoissonNoise(testImage, 1.0, 5), cv::NORM_INF) == 0;
+
+    std::cout << "Mean/variance at 100: " << mean << "/" << variance
+              << ", scale 4: " << mean4 << "/" << variance4 << std::endl;
+    if (statsOk && deterministic) {
+        std::cout << "Poisson noise test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Poisson noise test FAILED." << std::endl;
+    return false;
+}
+
+bool testSaltPepperNoise() {
+    std::cout << "Testing sparse salt and pepper noise..." << std::endl;
+
+    cv::Mat testImage = cv::Mat::ones(500, 400, CV_8UC3) * 128;
+
+    // Probabilities are not quantized to 1/255 steps
+    cv::Mat noisy = addSaltPepperNoise(testImage, 0.013, 0.002, 11);
+    int salt = 0, pepper = 0;
+    for (int y = 0; y < noisy.rows; ++y) {
+        for (int x = 0; x < noisy.cols; ++x) {
+            cv::Vec3b pixel = noisy.at<cv::Vec3b>(y, x);
+            if (pixel == cv::Vec3b(255, 255, 255)) salt++;
+            else if (pixel == cv::Vec3b(0, 0, 0)) pepper++;
+        }
+    }
+    double total = testImage.total();
+    bool ratiosOk = std::abs(salt / total - 0.013) < 0.001 && std::abs(pepper / total - 0.002) < 0.0005;
+
+    int threads = cv::getNumThreads();
+    cv::setNumThreads(1);
+    cv::Mat single = addSaltPepperNoise(testImage, 0.013, 0.002, 11);
+    cv::setNumThreads(threads);
+    bool deterministic = cv::norm(single, noisy, cv::NORM_INF) == 0;
+
+    cv::Mat all = addSaltPepperNoise(testImage, 0.5, 0.5, 3);
+    bool allCorrupted = cv::countNonZero(all.reshape(1) == 128) == 0;
+
+    std::cout << "Salt ratio: " << salt / total << ", pepper ratio: " << pepper / total << std::endl;
+    if (ratiosOk && deterministic && allCorrupted) {
+        std::cout << "Sparse salt and pepper noise test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Sparse salt and pepper noise test FAILED." << std::endl;
+    return false;
+}
+
 bool testAutoContrast() {
     std::cout << "Testing auto contrast..." << std::endl;
 
@@ -72,6 +275,233 @@ bool testAutoContrast() {
     return true;
 }
 
+bool testPointOps() {
+    std::cout << "Testing point operation fusion..." << std::endl;
+
+    cv::Mat testImage(80, 80, CV_8UC3);
+    cv::randu(testImage, cv::Scalar::all(40), cv::Scalar::all(200));
+
+    cv::Mat lut(1, 256, CV_8U);
+    for (int i = 0; i < 256; ++i) {
+        lut.at<uchar>(i) = static_cast<uchar>(255 - i);
+    }
+
+    // Reference: the operations one after another
+    cv::Mat expected = gammaCorrection(testImage, 2.2);
+    double alpha, beta;
+    autoContrastCoefficients(expected, 1.0, alpha, beta);
+    expected.convertTo(expected, -1, alpha, beta);
+    cv::LUT(expected, lut, expected);
+    cv::threshold(expected, expected, 100, 255, cv::THRESH_TRUNC);
+
+    cv::Mat fused = PointOps().gamma(2.2).linear(alpha, beta).lut(lut).threshold(100, 255, cv::THRESH_TRUNC).apply(testImage);
+
+    bool identical = fused.type() == expected.type() && cv::norm(fused, expected, cv::NORM_INF) == 0;
+    if (identical) {
+        std::cout << "Point operation fusion test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Point operation fusion test FAILED." << std::endl;
+    return false;
+}
+
+bool testTemporalAutoContrast() {
+    std::cout << "Testing temporal auto contrast..." << std::endl;
+
+    cv::Mat frame(120, 160, CV_8UC1);
+    cv::randu(frame, cv::Scalar(60), cv::Scalar(180));
+
+    // Without subsampling the first frame matches autoContrast exactly
+    TemporalAutoContrast exact(1.0, 0.5, 1);
+    bool firstMatches = cv::norm(exact.apply(frame), autoContrast(frame, 1.0), cv::NORM_INF) == 0;
+
+    // A sudden brightness jump moves the clip points only part of the way
+    TemporalAutoContrast smoothed(1.0, 0.25, 2);
+    for (int i = 0; i < 8; ++i) {
+        smoothed.apply(frame);
+    }
+    double lowBefore = smoothed.getLow();
+    cv::Mat brighter = frame + cv::Scalar(40);
+    smoothed.apply(brighter);
+    double step = smoothed.getLow() - lowBefore;
+    bool isSmoothed = step > 0 && step < 20;
+
+    cv::Mat color(60, 80, CV_8UC3);
+    cv::randu(color, cv::Scalar::all(0), cv::Scalar::all(256));
+    bool colorWorks = smoothed.apply(color).type() == CV_8UC3;
+
+    if (firstMatches && isSmoothed && colorWorks) {
+        std::cout << "Temporal auto contrast test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Temporal auto contrast test FAILED." << std::endl;
+    return false;
+}
+
+bool testClaheEngine() {
+    std::cout << "Testing CLAHE engine..." << std::endl;
+
+    cv::Mat gray(128, 128, CV_8UC1);
+    cv::randu(gray, cv::Scalar(80), cv::Scalar(140));
+
+    // Gray input matches a fresh cv::CLAHE, also on repeated calls
+    ClaheEngine engine(2.0, cv::Size(8, 8));
+    cv::Mat expected;
+    cv::createCLAHE(2.0, cv::Size(8, 8))->apply(gray, expected);
+    bool grayMatches = true;
+    for (int i = 0; i < 3; ++i) {
+        grayMatches &= cv::norm(engine.apply(gray), expected, cv::NORM_INF) == 0;
+    }
+
+    // Color input keeps its chroma: away from saturation all channels move together
+    cv::Mat color(128, 128, CV_8UC3);
+    cv::randu(color, cv::Scalar(60, 90, 120), cv::Scalar(100, 130, 160));
+    cv::Mat result = engine.apply(color);
+    bool chromaKept = result.type() == CV_8UC3;
+    for (int y = 0; y < color.rows && chromaKept; ++y) {
+        for (int x = 0; x < color.cols; ++x) {
+            cv::Vec3b in = color.at<cv::Vec3b>(y, x), out = result.at<cv::Vec3b>(y, x);
+            bool saturated = false;
+            for (int c = 0; c < 3; ++c) {
+                saturated |= out[c] == 0 || out[c] == 255;
+            }
+            if (saturated) {
+                continue;
+            }
+            if (out[0] - in[0] != out[1] - in[1] || out[1] - in[1] != out[2] - in[2]) {
+                chromaKept = false;
+                break;
+            }
+        }
+    }
+
+    ClaheEngine labEngine(2.0, cv::Size(8, 8), ClaheColorSpace::Lab);
+    bool labWorks = labEngine.apply(color).type() == CV_8UC3;
+
+    if (grayMatches && chromaKept && labWorks) {
+        std::cout << "CLAHE engine test passed." << std::endl;
+        return true;
+    }
+    std::cout << "CLAHE engine test FAILED." << std::endl;
+    return false;
+}
+
+bool testColorEqualization() {
+    std::cout << "Testing color histogram equalization..." << std::endl;
+
+    // Gray input matches cv::equalizeHist
+    cv::Mat gray(100, 100, CV_8UC1);
+    cv::randu(gray, cv::Scalar(90), cv::Scalar(150));
+    cv::Mat expected;
+    cv::equalizeHist(gray, expected);
+    bool grayMatches = cv::norm(adaptiveHistogramEqualization(gray), expected, cv::NORM_INF) == 0;
+
+    // Color input: luma is spread over the range, the result is not gray
+    cv::Mat color(100, 100, CV_8UC3);
+    cv::randu(color, cv::Scalar(40, 90, 110), cv::Scalar(80, 130, 150));
+    cv::Mat result = adaptiveHistogramEqualization(color);
+    double minLuma, maxLuma;
+    cv::minMaxLoc(convertToGrayscale(result), &minLuma, &maxLuma);
+    cv::Scalar meanColor = cv::mean(result);
+    bool colorKept = result.type() == CV_8UC3 && maxLuma - minLuma > 150 && meanColor[2] - meanColor[0] > 30;
+
+    if (grayMatches && colorKept) {
+        std::cout << "Color histogram equalization test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Color histogram equalization test FAILED." << std::endl;
+    return false;
+}
+
+bool testHistogram() {
+    std::cout << "Testing histogram engine..." << std::endl;
+
+    cv::Mat testImage(300, 400, CV_8UC3);
+    cv::randu(testImage, cv::Scalar::all(0), cv::Scalar::all(256));
+    testImage(cv::Rect(0, 0, 100, 100)).setTo(cv::Scalar(7, 7, 7));
+
+    // Per-channel counts match a direct loop, the joint histogram is their sum
+    std::vector<std::vector<uint64_t>> channels = computeChannelHistograms(testImage);
+    std::vector<uint64_t> joint = computeHistogram(testImage);
+    std::vector<std::vector<uint64_t>> expected(3, std::vector<uint64_t>(256, 0));
+    for (int y = 0; y < testImage.rows; ++y) {
+        for (int x = 0; x < testImage.cols; ++x) {
+            cv::Vec3b pixel = testImage.at<cv::Vec3b>(y, x);
+            for (int c = 0; c < 3; ++c) {
+                expected[c][pixel[c]]++;
+            }
+        }
+    }
+    bool countsMatch = channels == expected;
+    for (int i = 0; i < 256 && countsMatch; ++i) {
+        countsMatch = joint[i] == expected[0][i] + expected[1][i] + expected[2][i];
+    }
+
+    // 16-bit histogram and percentile on a known ramp
+    cv::Mat ramp(1, 1000, CV_16UC1);
+    for (int i = 0; i < ramp.cols; ++i) {
+        ramp.at<ushort>(i) = static_cast<ushort>(i * 60);
+    }
+    std::vector<uint64_t> cumulative = cumulativeHistogram(computeHistogram(ramp));
+    bool percentileMatch = cumulative.size() == 65536 && cumulative.back() == 1000 &&
+                           histogramPercentile(cumulative, 50.0) == 499 * 60;
+
+    // Otsu value matches OpenCV
+    cv::Mat gray = convertToGrayscale(testImage);
+    cv::Mat otsuResult;
+    double opencvOtsu = cv::threshold(gray, otsuResult, 0, 255, cv::THRESH_BINARY + cv::THRESH_OTSU);
+    bool otsuMatch = otsuThresholdValue(computeHistogram(gray)) == static_cast<int>(opencvOtsu);
+
+    if (countsMatch && percentileMatch && otsuMatch) {
+        std::cout << "Histogram engine test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Histogram engine test FAILED." << std::endl;
+    return false;
+}
+
+bool testQualityMetrics() {
+    std::cout << "Testing quality metrics..." << std::endl;
+
+    cv::Mat reference(90, 120, CV_8UC3);
+    cv::randu(reference, cv::Scalar::all(30), cv::Scalar::all(220));
+    cv::Mat candidate = reference.clone();
+    candidate(cv::Rect(0, 0, 60, 90)) += cv::Scalar(4, 0, 0);
+    candidate.at<cv::Vec3b>(5, 100)[2] = 0;
+
+    // Per-channel and overall values match OpenCV built-ins
+    QualityStats stats = computeQuality(reference, candidate);
+    cv::Mat diff;
+    cv::absdiff(reference, candidate, diff);
+    diff.convertTo(diff, CV_64F);
+    cv::Scalar expectedMSE = cv::mean(diff.mul(diff));
+    bool mseMatches = true;
+    for (int c = 0; c < 3; ++c) {
+        mseMatches &= std::abs(stats.mse[c] - expectedMSE[c]) < 1e-9;
+    }
+    mseMatches &= std::abs(stats.psnrAll - cv::PSNR(reference, candidate)) < 1e-6;
+    double maxError;
+    cv::minMaxLoc(diff.reshape(1), nullptr, &maxError);
+    bool maxMatches = stats.maxError == maxError && stats.noiseMean[0] == 2.0;
+
+    // Batch gives the same numbers as single comparisons
+    std::vector<QualityStats> batch = computeQuality(reference, std::vector<cv::Mat>{reference, candidate});
+    bool batchMatches = std::isinf(batch[0].psnrAll) && batch[1].mseAll == stats.mseAll;
+
+    // SSIM is 1 for identical images and drops with noise
+    cv::Mat noisy = addGaussianNoise(reference, 0, 20, 1);
+    cv::Scalar ssimSame = computeSSIM(reference, reference);
+    cv::Scalar ssimNoisy = computeSSIM(reference, noisy);
+    bool ssimOk = std::abs(ssimSame[0] - 1.0) < 1e-9 && ssimNoisy[0] < 0.95 && ssimNoisy[0] > 0.0;
+
+    if (mseMatches && maxMatches && batchMatches && ssimOk) {
+        std::cout << "Quality metrics test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Quality metrics test FAILED." << std::endl;
+    return false;
+}
+
 bool testBinarization() {
     std::cout << "Testing binarization..." << std::endl;
 
@@ -90,6 +520,157 @@ bool testBinarization() {
     return true;
 }
 
+bool testIntegralImage() {
+    std::cout << "Testing integral image and local thresholds..." << std::endl;
+
+    // Rectangle sums and squared sums match cv::sum, for 8 and 16 bits
+    cv::Mat image(237, 311, CV_8UC1), deep(90, 70, CV_16UC1);
+    cv::randu(image, cv::Scalar(0), cv::Scalar(256));
+    cv::randu(deep, cv::Scalar(0), cv::Scalar(65536));
+    IntegralImage integral(image), deepIntegral(deep);
+    cv::Rect rect(17, 40, 120, 150);
+    cv::Mat patch, squared;
+    image(rect).convertTo(patch, CV_64F);
+    cv::multiply(patch, patch, squared);
+    bool sumsMatch = integral.sum(rect) == static_cast<int64_t>(cv::sum(patch)[0]) &&
+                     integral.squareSum(rect) == static_cast<int64_t>(cv::sum(squared)[0]) &&
+                     deepIntegral.sum(cv::Rect(0, 0, 70, 90)) == static_cast<int64_t>(cv::sum(deep)[0]);
+
+    // Box mean equals cv::blur away from the borders, variance equals the patch variance
+    cv::Mat mean, variance, blurred;
+    integral.boxMeanVariance(cv::Size(15, 15), mean, variance);
+    cv::blur(image, blurred, cv::Size(15, 15));
+    cv::Mat blurred32f;
+    blurred.convertTo(blurred32f, CV_32F);
+    cv::Rect interior(7, 7, image.cols - 14, image.rows - 14);
+    cv::Scalar patchMean, patchStddev;
+    cv::meanStdDev(image(cv::Rect(93, 53, 15, 15)), patchMean, patchStddev);
+    bool statsMatch = cv::norm(mean(interior), blurred32f(interior), cv::NORM_INF) <= 0.5 &&
+                      std::abs(variance.at<float>(60, 100) - patchStddev[0] * patchStddev[0]) < 1e-2;
+
+    // Dark strokes on an unevenly lit page: Sauvola keeps both the page and the strokes
+    cv::Mat page(200, 300, CV_8UC1);
+    for (int y = 0; y < page.rows; ++y) {
+        for (int x = 0; x < page.cols; ++x) {
+            page.at<uchar>(y, x) = static_cast<uchar>(90 + x / 2);
+        }
+    }
+    cv::Mat strokes = cv::Mat::zeros(page.size(), CV_8UC1);
+    for (int x = 20; x < 280; x += 30) {
+        cv::line(strokes, cv::Point(x, 30), cv::Point(x + 10, 170), cv::Scalar(255), 3);
+    }
+    page.setTo(cv::Scalar(40), strokes);
+    IntegralImage pageIntegral(page);
+    cv::Mat sauvola = sauvolaThreshold(page, pageIntegral, 31, 0.2, 128);
+    double strokeMiss = cv::mean(sauvola, strokes)[0] / 255.0;
+    double pageKept = cv::mean(sauvola, 255 - strokes)[0] / 255.0;
+    bool sharedMatches = cv::norm(niblackThreshold(page, pageIntegral), niblackThreshold(page), cv::NORM_INF) == 0 &&
+                         cv::norm(bradleyThreshold(page, pageIntegral), bradleyThreshold(page), cv::NORM_INF) == 0;
+
+    if (sumsMatch && statsMatch && strokeMiss < 0.02 && pageKept > 0.95 && sharedMatches) {
+        std::cout << "Integral image and local thresholds test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Integral image and local thresholds test FAILED." << std::endl;
+    return false;
+}
+
+bool testStreamingBinarization() {
+    std::cout << "Testing streaming binarization..." << std::endl;
+
+    // Strip heights that do not divide the image, and strips thinner than the halo
+    cv::Mat image(301, 257, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::GaussianBlur(image, image, cv::Size(9, 9), 3);
+    bool matches = true;
+    for (int stripHeight : {7, 64, 400}) {
+        matches &= cv::norm(binarizeTiled(image, StreamingThreshold::Otsu, 11, 2, stripHeight), otsuThreshold(image), cv::NORM_INF) == 0;
+        matches &= cv::norm(binarizeTiled(image, StreamingThreshold::AdaptiveMean, 15, 3, stripHeight),
+                            adaptiveThreshold(image, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, 15, 3), cv::NORM_INF) == 0;
+        matches &= cv::norm(binarizeTiled(image, StreamingThreshold::AdaptiveGaussian, 11, 2, stripHeight),
+                            adaptiveThreshold(image, 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY, 11, 2), cv::NORM_INF) == 0;
+    }
+
+    // Rows arrive in order and exactly once
+    cv::Mat gray = convertToGrayscale(image);
+    int nextRow = 0;
+    bool ordered = true;
+    binarizeStreaming(gray.size(), [&](int first, cv::Mat& rows) {
+        gray.rowRange(first, first + rows.rows).copyTo(rows);
+    }, [&](int first, const cv::Mat& rows) {
+        ordered &= first == nextRow;
+        nextRow = first + rows.rows;
+    }, StreamingThreshold::AdaptiveGaussian, 11, 2, 50);
+    ordered &= nextRow == gray.rows;
+
+    if (matches && ordered) {
+        std::cout << "Streaming binarization test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Streaming binarization test FAILED." << std::endl;
+    return false;
+}
+
+bool testMultiOtsu() {
+    std::cout << "Testing multi-level Otsu..." << std::endl;
+
+    // Three noisy flat regions are labelled 0, 1, 2
+    cv::Mat image(90, 150, CV_8UC1);
+    image.colRange(0, 50).setTo(30);
+    image.colRange(50, 100).setTo(120);
+    image.colRange(100, 150).setTo(220);
+    image = addGaussianNoise(image, 0, 6, 11);
+    std::vector<int> thresholds;
+    cv::Mat labels = multiOtsuThreshold(image, 3, &thresholds);
+    bool labelled = thresholds.size() == 2 && labels.at<uchar>(45, 25) == 0 && labels.at<uchar>(45, 75) == 1 &&
+                    labels.at<uchar>(45, 125) == 2 && thresholds[0] > 50 && thresholds[0] < 100 &&
+                    thresholds[1] > 140 && thresholds[1] < 200;
+
+    // Two classes agree with the classic Otsu threshold
+    cv::Mat smooth(120, 160, CV_8UC1);
+    cv::randu(smooth, cv::Scalar(0), cv::Scalar(256));
+    cv::GaussianBlur(smooth, smooth, cv::Size(0, 0), 4);
+    std::vector<uint64_t> histogram = computeHistogram(smooth);
+    bool matchesOtsu = multiOtsuThresholds(histogram, 2).front() == otsuThresholdValue(histogram);
+
+    // Four classes on a small histogram: the DP finds the exhaustive optimum
+    std::vector<uint64_t> small(24);
+    for (size_t i = 0; i < small.size(); ++i) {
+        small[i] = (i * 37 + 11) % 17 + (i % 6 == 0 ? 40 : 0);
+    }
+    auto variance = [&](const std::vector<int>& t) {
+        double score = 0.0;
+        int first = 0;
+        for (size_t c = 0; c <= t.size(); ++c) {
+            int last = c < t.size() ? t[c] + 1 : static_cast<int>(small.size());
+            double p = 0.0, m = 0.0;
+            for (int i = first; i < last; ++i) {
+                p += small[i];
+                m += i * static_cast<double>(small[i]);
+            }
+            score += p > 0 ? m * m / p : 0.0;
+            first = last;
+        }
+        return score;
+    };
+    double exhaustive = 0.0;
+    for (int a = 0; a < 24; ++a) {
+        for (int b = a + 1; b < 24; ++b) {
+            for (int c = b + 1; c < 23; ++c) {
+                exhaustive = std::max(exhaustive, variance({a, b, c}));
+            }
+        }
+    }
+    bool optimal = std::abs(variance(multiOtsuThresholds(small, 4)) - exhaustive) < 1e-6 * exhaustive;
+
+    if (labelled && matchesOtsu && optimal) {
+        std::cout << "Multi-level Otsu test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Multi-level Otsu test FAILED." << std::endl;
+    return false;
+}
+
 bool testLinearFiltering() {
     std::cout << "Testing linear filtering..." << std::endl;
 
@@ -108,6 +689,200 @@ bool testLinearFiltering() {
     return true;
 }
 
+bool testAdaptiveMedian() {
+    std::cout << "Testing adaptive median filter..." << std::endl;
+
+    // Fine random texture: a plain median filter destroys it
+    cv::Mat clean(120, 160, CV_8UC3);
+    cv::randu(clean, cv::Scalar::all(40), cv::Scalar::all(216));
+    // A saturated block is real content, not noise
+    clean(cv::Rect(100, 10, 20, 20)).setTo(cv::Scalar::all(255));
+    cv::Mat noisy = addSaltPepperNoise(clean, 0.1, 0.1, 21);
+
+    cv::Mat filtered = adaptiveMedianFilter(noisy);
+
+    // Uncorrupted pixels pass through unchanged, the saturated block and its corners included
+    bool cleanKept = true;
+    for (int y = 0; y < noisy.rows && cleanKept; ++y) {
+        for (int x = 0; x < noisy.cols; ++x) {
+            if (noisy.at<cv::Vec3b>(y, x) == clean.at<cv::Vec3b>(y, x) &&
+                filtered.at<cv::Vec3b>(y, x) != clean.at<cv::Vec3b>(y, x)) {
+                cleanKept = false;
+                break;
+            }
+        }
+    }
+    double psnrAdaptive = computeQuality(clean, filtered).psnrAll;
+    double psnrMedian = computeQuality(clean, medianFilter(noisy, 5)).psnrAll;
+
+    std::cout << "PSNR adaptive: " << psnrAdaptive << " dB, median 5x5: " << psnrMedian << " dB" << std::endl;
+    if (cleanKept && psnrAdaptive > psnrMedian) {
+        std::cout << "Adaptive median filter test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Adaptive median filter test FAILED." << std::endl;
+    return false;
+}
+
+bool testLargeMedian() {
+    std::cout << "Testing large-kernel median filter..." << std::endl;
+
+    // Same result as cv::medianBlur for large square windows
+    cv::Mat image(150, 200, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::Mat expected;
+    cv::medianBlur(image, expected, 15);
+    bool squareMatches = cv::norm(medianFilter(image, 15), expected, cv::NORM_INF) == 0;
+
+    // Rectangular windows and 16-bit input against a direct median with replicated borders
+    auto directMedian = [](const cv::Mat& src, cv::Size ksize) {
+        cv::Mat padded, dst(src.size(), src.type());
+        int rx = ksize.width / 2, ry = ksize.height / 2;
+        cv::copyMakeBorder(src, padded, ry, ry, rx, rx, cv::BORDER_REPLICATE);
+        std::vector<ushort> window;
+        for (int y = 0; y < src.rows; ++y) {
+            for (int x = 0; x < src.cols; ++x) {
+                window.clear();
+                for (int dy = 0; dy < ksize.height; ++dy) {
+                    for (int dx = 0; dx < ksize.width; ++dx) {
+                        window.push_back(src.depth() == CV_8U ? padded.at<uchar>(y + dy, x + dx) : padded.at<ushort>(y + dy, x + dx));
+                    }
+                }
+                std::nth_element(window.begin(), window.begin() + window.size() / 2, window.end());
+                if (src.depth() == CV_8U) dst.at<uchar>(y, x) = static_cast<uchar>(window[window.size() / 2]);
+                else dst.at<ushort>(y, x) = window[window.size() / 2];
+            }
+        }
+        return dst;
+    };
+    cv::Mat gray(70, 150, CV_8UC1);
+    cv::randu(gray, cv::Scalar(0), cv::Scalar(256));
+    bool rectMatches = cv::norm(medianFilter(gray, cv::Size(9, 3)), directMedian(gray, cv::Size(9, 3)), cv::NORM_INF) == 0;
+
+    cv::Mat deep(60, 140, CV_16UC1);
+    cv::randu(deep, cv::Scalar(0), cv::Scalar(65536));
+    bool deepMatches = cv::norm(medianFilter(deep, cv::Size(7, 11)), directMedian(deep, cv::Size(7, 11)), cv::NORM_INF) == 0;
+
+    if (squareMatches && rectMatches && deepMatches) {
+        std::cout << "Large-kernel median filter test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Large-kernel median filter test FAILED." << std::endl;
+    return false;
+}
+
+bool testBilateralGrid() {
+    std::cout << "Testing bilateral grid filter..." << std::endl;
+
+    // Noisy step edge: close to the exact filter, and the edge survives
+    cv::Mat image(120, 160, CV_8UC1, cv::Scalar(60));
+    image(cv::Rect(80, 0, 80, 120)).setTo(190);
+    image = addGaussianNoise(image, 0, 8, 7);
+
+    QualityStats coarse = bilateralGridError(image, 30, 10, 1.0);
+    QualityStats fine = bilateralGridError(image, 30, 10, 0.5);
+    cv::Mat smoothed = bilateralGridFilter(image, 30, 10);
+    double left = cv::mean(smoothed(cv::Rect(0, 0, 70, 120)))[0];
+    double right = cv::mean(smoothed(cv::Rect(90, 0, 70, 120)))[0];
+
+    // Wide spatial sigmas with a full window are routed to the grid, truncated windows are not
+    cv::Mat color, exact;
+    cv::cvtColor(image, color, cv::COLOR_GRAY2BGR);
+    cv::bilateralFilter(color, exact, 9, 30, 10);
+    bool routed = cv::norm(bilateralFilter(color, 31, 30, 10), bilateralGridFilter(color, 30, 10), cv::NORM_INF) == 0 &&
+                  cv::norm(bilateralFilter(color, 9, 30, 10), exact, cv::NORM_INF) == 0;
+
+    if (coarse.psnrAll > 30 && fine.psnrAll > coarse.psnrAll && right - left > 120 && routed) {
+        std::cout << "Bilateral grid filter test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Bilateral grid filter test FAILED." << std::endl;
+    return false;
+}
+
+bool testRecursiveGaussian() {
+    std::cout << "Testing recursive Gaussian filter..." << std::endl;
+
+    // Close to the FIR filter with the same border, replicated or reflected; gaussianFilter
+    // routes to the recursive filter with GaussianBlur's default border
+    cv::Mat image(200, 240, CV_32FC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+    bool accurate = true;
+    for (double sigma : {12.0, 40.0}) {
+        int ksize = 2 * static_cast<int>(std::ceil(4 * sigma)) + 1;
+        cv::Mat fir, firReflect;
+        cv::GaussianBlur(image, fir, cv::Size(ksize, ksize), sigma, sigma, cv::BORDER_REPLICATE);
+        accurate &= cv::norm(recursiveGaussianFilter(image, sigma), fir, cv::NORM_INF) < 2.0;
+        cv::GaussianBlur(image, firReflect, cv::Size(ksize, ksize), sigma, sigma);
+        accurate &= cv::norm(recursiveGaussianFilter(image, sigma, 0, cv::BORDER_REFLECT_101), firReflect, cv::NORM_INF) < 2.0;
+        accurate &= cv::norm(gaussianFilter(image, cv::Size(0, 0), sigma), firReflect, cv::NORM_INF) < 2.0;
+    }
+
+    // A constant image stays constant up to the borders
+    cv::Mat flat(50, 60, CV_8UC1, cv::Scalar(173));
+    bool flatKept = cv::norm(recursiveGaussianFilter(flat, 30), flat, cv::NORM_INF) == 0;
+
+    std::vector<GaussianTiming> timings = benchmarkGaussianFilters(image, {2, 8, 32}, 1);
+    for (const auto& timing : timings) {
+        std::cout << "  sigma " << timing.sigma << ": FIR " << timing.firMs << " ms, IIR " << timing.iirMs << " ms" << std::endl;
+    }
+
+    if (accurate && flatKept && timings.size() == 3) {
+        std::cout << "Recursive Gaussian filter test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Recursive Gaussian filter test FAILED." << std::endl;
+    return false;
+}
+
+bool testCustomLinearFilter() {
+    std::cout << "Testing custom linear filter dispatch..." << std::endl;
+
+    cv::Mat image(180, 210, CV_32FC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+    auto matchesFilter2D = [&](const cv::Mat& kernel, double tolerance) {
+        cv::Mat expected;
+        cv::filter2D(image, expected, -1, kernel);
+        return cv::norm(customLinearFilter(image, kernel), expected, cv::NORM_INF) < tolerance;
+    };
+
+    // Rank 1 and rank 2 kernels go through separable passes
+    cv::Mat g15 = cv::getGaussianKernel(15, 3.0, CV_32F), g25 = cv::getGaussianKernel(25, 5.0, CV_32F);
+    cv::Mat rank1 = g15 * g15.t();
+    cv::Mat d25 = cv::Mat::zeros(25, 1, CV_32F);
+    d25.at<float>(10) = -1.0f;
+    d25.at<float>(14) = 1.0f;
+    cv::Mat rank2 = g25 * g25.t() + d25 * d25.t();
+    bool separable = linearFilterMethod(rank1) == LinearFilterMethod::Separable &&
+                     linearFilterMethod(rank2) == LinearFilterMethod::Separable &&
+                     matchesFilter2D(rank1, 1e-2) && matchesFilter2D(rank2, 1e-2);
+
+    // Large full-rank kernels use the tiled FFT, asymmetric sizes included
+    cv::Mat large(31, 27, CV_32F);
+    cv::randu(large, cv::Scalar(0), cv::Scalar(1));
+    large /= cv::sum(large)[0];
+    bool fft = linearFilterMethod(large) == LinearFilterMethod::Fft && matchesFilter2D(large, 1e-2);
+
+    // Small full-rank kernels stay on filter2D and give exactly its result
+    cv::Mat sharpen = (cv::Mat_<float>(3, 3) << 0, -1, 0, -1, 5, -1, 0, -1, 0);
+    cv::Mat image8u, sharpened8u, expected8u;
+    image.convertTo(image8u, CV_8U);
+    cv::filter2D(image8u, sharpened8u, -1, sharpen);
+    bool direct = linearFilterMethod(sharpen) == LinearFilterMethod::Direct &&
+                  cv::norm(customLinearFilter(image8u, sharpen), sharpened8u, cv::NORM_INF) == 0;
+
+    // Separable passes on 8-bit agree with filter2D up to rounding
+    cv::filter2D(image8u, expected8u, -1, rank1);
+    separable &= cv::norm(customLinearFilter(image8u, rank1), expected8u, cv::NORM_INF) <= 1;
+
+    if (separable && fft && direct) {
+        std::cout << "Custom linear filter dispatch test passed." << std::endl;
+        return true;
+    }
+    std::cout << "Custom linear filter dispatch test FAILED." << std::endl;
+    return false;
+}
+
 bool testObjectDetection() {
     std::cout << "Testing object detection..." << std::endl;
 